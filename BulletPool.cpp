@@ -0,0 +1,180 @@
+#include "BulletPool.hpp"
+
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+BulletPool::BulletPool(uint32_t capacity_) : capacity(capacity_) {
+	uint32_t padded = (capacity + ZEUS_SIMD_WIDTH - 1) / ZEUS_SIMD_WIDTH * ZEUS_SIMD_WIDTH;
+	x.assign(padded, 0.0f);
+	y.assign(padded, 0.0f);
+	px.assign(padded, 0.0f);
+	py.assign(padded, 0.0f);
+	vx.assign(padded, 0.0f);
+	vy.assign(padded, 0.0f);
+	age.assign(padded, 0.0f);
+	alive.assign(padded, 0);
+	free_list.reserve(capacity);
+}
+
+uint32_t BulletPool::spawn(glm::vec2 const &position, glm::vec2 const &velocity) {
+	//reuse a dead slot if there is one, otherwise extend the used range:
+	uint32_t i;
+	if (!free_list.empty()) {
+		i = free_list.back();
+		free_list.pop_back();
+	} else if (end < capacity) {
+		i = end;
+		end += 1;
+	} else {
+		return Invalid;
+	}
+
+	x[i] = px[i] = position.x;
+	y[i] = py[i] = position.y;
+	vx[i] = velocity.x;
+	vy[i] = velocity.y;
+	age[i] = 0.0f;
+	alive[i] = 1;
+
+	live += 1;
+	return i;
+}
+
+void BulletPool::kill(uint32_t i) {
+	assert(i < capacity && alive[i]);
+	alive[i] = 0;
+	//park dead slots at rest so the batch kernels keep them finite:
+	vx[i] = 0.0f;
+	vy[i] = 0.0f;
+	free_list.emplace_back(i);
+	live -= 1;
+	if (live == 0) {
+		//nothing left in flight; restart from slot zero so batches stay short:
+		end = 0;
+		free_list.clear();
+	}
+}
+
+void BulletPool::integrate(float elapsed, glm::vec2 const &gravity) {
+	//per-step constants of the displacement formula:
+	glm::vec2 dp = 0.5f * gravity * elapsed * elapsed;
+	glm::vec2 dv = gravity * elapsed;
+	uint32_t n = (end + ZEUS_SIMD_WIDTH - 1) / ZEUS_SIMD_WIDTH * ZEUS_SIMD_WIDTH;
+
+#if ZEUS_SSE2
+	__m128 t = _mm_set1_ps(elapsed);
+	__m128 dpx = _mm_set1_ps(dp.x), dpy = _mm_set1_ps(dp.y);
+	__m128 dvx = _mm_set1_ps(dv.x), dvy = _mm_set1_ps(dv.y);
+	__m128i ZERO = _mm_setzero_si128();
+	//select(m, a, b) == m ? a : b (per lane):
+	#define SELECT( M, A, B ) _mm_or_ps(_mm_and_ps(M, A), _mm_andnot_ps(M, B))
+	for (uint32_t i = 0; i < n; i += 4) {
+		//dead lanes stay where they are (otherwise they would keep falling, and keep being clamped to the floor):
+		int32_t flags;
+		std::memcpy(&flags, &alive[i], 4);
+		__m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(flags), ZERO), ZERO);
+		__m128 m = _mm_castsi128_ps(_mm_cmpgt_epi32(lanes, ZERO));
+
+		__m128 X = _mm_loadu_ps(&x[i]);
+		__m128 Y = _mm_loadu_ps(&y[i]);
+		__m128 VX = _mm_loadu_ps(&vx[i]);
+		__m128 VY = _mm_loadu_ps(&vy[i]);
+		_mm_storeu_ps(&px[i], X);
+		_mm_storeu_ps(&py[i], Y);
+		_mm_storeu_ps(&x[i], SELECT(m, _mm_add_ps(X, _mm_add_ps(_mm_mul_ps(VX, t), dpx)), X));
+		_mm_storeu_ps(&y[i], SELECT(m, _mm_add_ps(Y, _mm_add_ps(_mm_mul_ps(VY, t), dpy)), Y));
+		_mm_storeu_ps(&vx[i], SELECT(m, _mm_add_ps(VX, dvx), VX));
+		_mm_storeu_ps(&vy[i], SELECT(m, _mm_add_ps(VY, dvy), VY));
+		_mm_storeu_ps(&age[i], _mm_add_ps(_mm_loadu_ps(&age[i]), _mm_and_ps(m, t)));
+	}
+	#undef SELECT
+#else
+	for (uint32_t i = 0; i < n; ++i) {
+		px[i] = x[i];
+		py[i] = y[i];
+		if (!alive[i]) continue; //dead slots stay where they are
+		x[i] += vx[i] * elapsed + dp.x;
+		y[i] += vy[i] * elapsed + dp.y;
+		vx[i] += dv.x;
+		vy[i] += dv.y;
+		age[i] += elapsed;
+	}
+#endif
+}
+
+void BulletPool::bounce_walls(glm::vec2 const &lo, glm::vec2 const &hi, std::vector< uint32_t > *landed) {
+	assert(landed);
+	uint32_t n = (end + ZEUS_SIMD_WIDTH - 1) / ZEUS_SIMD_WIDTH * ZEUS_SIMD_WIDTH;
+
+#if ZEUS_SSE2
+	__m128 LOX = _mm_set1_ps(lo.x), LOY = _mm_set1_ps(lo.y);
+	__m128 HIX = _mm_set1_ps(hi.x), HIY = _mm_set1_ps(hi.y);
+	__m128 ZERO = _mm_setzero_ps();
+	__m128 SIGN = _mm_set1_ps(-0.0f);
+	//select(m, a, b) == m ? a : b (per lane):
+	#define SELECT( M, A, B ) _mm_or_ps(_mm_and_ps(M, A), _mm_andnot_ps(M, B))
+	for (uint32_t i = 0; i < n; i += 4) {
+		__m128 X = _mm_loadu_ps(&x[i]);
+		__m128 Y = _mm_loadu_ps(&y[i]);
+		__m128 VX = _mm_loadu_ps(&vx[i]);
+		__m128 VY = _mm_loadu_ps(&vy[i]);
+		__m128 m;
+
+		//top wall: clamp, and make sure velocity points down:
+		m = _mm_cmpgt_ps(Y, HIY);
+		Y = _mm_min_ps(Y, HIY);
+		VY = SELECT(m, _mm_or_ps(VY, SIGN), VY);
+
+		//bottom wall: clamp, and report bullets still moving down:
+		m = _mm_cmplt_ps(Y, LOY);
+		Y = _mm_max_ps(Y, LOY);
+		int hits = _mm_movemask_ps(_mm_and_ps(m, _mm_cmplt_ps(VY, ZERO)));
+
+		//right wall: clamp, and make sure velocity points left:
+		m = _mm_cmpgt_ps(X, HIX);
+		X = _mm_min_ps(X, HIX);
+		VX = SELECT(m, _mm_or_ps(VX, SIGN), VX);
+
+		//left wall: clamp, and make sure velocity points right:
+		m = _mm_cmplt_ps(X, LOX);
+		X = _mm_max_ps(X, LOX);
+		VX = SELECT(m, _mm_andnot_ps(SIGN, VX), VX);
+
+		_mm_storeu_ps(&x[i], X);
+		_mm_storeu_ps(&y[i], Y);
+		_mm_storeu_ps(&vx[i], VX);
+		_mm_storeu_ps(&vy[i], VY);
+
+		while (hits) {
+			uint32_t lane = 0;
+			while (!(hits & (1 << lane))) ++lane;
+			hits &= ~(1 << lane);
+			if (alive[i + lane]) landed->emplace_back(i + lane);
+		}
+	}
+	#undef SELECT
+#else
+	for (uint32_t i = 0; i < n; ++i) {
+		if (y[i] > hi.y) {
+			y[i] = hi.y;
+			vy[i] = -std::abs(vy[i]);
+		}
+		if (y[i] < lo.y) {
+			y[i] = lo.y;
+			if (vy[i] < 0.0f && alive[i]) landed->emplace_back(i);
+		}
+		if (x[i] > hi.x) {
+			x[i] = hi.x;
+			vx[i] = -std::abs(vx[i]);
+		}
+		if (x[i] < lo.x) {
+			x[i] = lo.x;
+			vx[i] = std::abs(vx[i]);
+		}
+	}
+#endif
+}
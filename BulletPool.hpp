@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+//Fixed-capacity pool of ballistic bullets stored as a structure of arrays.
+// Slots are recycled through a free list, so firing never allocates.
+// Slots [0,end) are integrated in SIMD batches; dead slots in that range are
+// masked out (they hold still, at rest) and are skipped by anything that reads results.
+struct BulletPool {
+	BulletPool(uint32_t capacity);
+
+	//claim a slot for a new bullet; returns Invalid if the pool is full:
+	static constexpr uint32_t Invalid = ~0U;
+	uint32_t spawn(glm::vec2 const &position, glm::vec2 const &velocity);
+
+	//return a slot to the free list:
+	void kill(uint32_t index);
+
+	//advance all bullets by 'elapsed' seconds under constant acceleration:
+	// (displacement formula p += v*t + 0.5*a*t*t, then v += a*t)
+	// positions before the step are kept in px/py for draw-time interpolation
+	void integrate(float elapsed, glm::vec2 const &gravity);
+
+	//clamp all bullets to the box [lo,hi] (lo/hi are bullet *centers*):
+	// - top and side walls reflect velocity away from the wall
+	// - the bottom wall appends the indices of live bullets moving downward to 'landed'
+	void bounce_walls(glm::vec2 const &lo, glm::vec2 const &hi, std::vector< uint32_t > *landed);
+
+	glm::vec2 position(uint32_t i) const { return glm::vec2(x[i], y[i]); }
+	//position 'alpha' of the way from the start of the last step to now:
+	glm::vec2 position(uint32_t i, float alpha) const { return glm::vec2(px[i] + (x[i] - px[i]) * alpha, py[i] + (y[i] - py[i]) * alpha); }
+	glm::vec2 velocity(uint32_t i) const { return glm::vec2(vx[i], vy[i]); }
+
+	uint32_t capacity = 0; //maximum number of live bullets
+	uint32_t live = 0; //number of live bullets
+	uint32_t end = 0; //one past the highest slot ever claimed
+
+	//per-bullet state, padded to a multiple of the SIMD width:
+	std::vector< float > x, y;   //position
+	std::vector< float > px, py; //position at the start of the last integrate()
+	std::vector< float > vx, vy; //velocity
+	std::vector< float > age;    //seconds since spawn
+	std::vector< uint8_t > alive;
+
+	std::vector< uint32_t > free_list; //stack of dead slots below 'end' (slots at or past 'end' are implicitly free)
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+//Counter-based pseudo-random numbers (SplitMix64):
+// draw n is a pure function of (seed, n), so the whole generator state is two integers.
+// Instances are independent, cheap to copy/save, and batches can be generated
+// out of order (or in parallel) with bit-identical results for a given seed.
+struct CounterRNG {
+	explicit CounterRNG(uint64_t seed_ = 0) : seed(seed_) { }
+
+	uint64_t seed;
+	uint64_t counter = 0; //number of values drawn so far
+
+	//the value at position 'n' in the stream for 'seed':
+	static uint64_t at(uint64_t seed, uint64_t n) {
+		uint64_t z = seed + (n + 1) * 0x9e3779b97f4a7c15ULL;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+	//top 24 bits as a float in [0,1):
+	static float to_float(uint64_t v) {
+		return float(v >> 40) * (1.0f / 16777216.0f);
+	}
+
+	uint64_t next() {
+		return at(seed, counter++);
+	}
+	//uniform in [0,1):
+	float next_float() {
+		return to_float(next());
+	}
+	//uniform in [lo,hi):
+	float next_float(float lo, float hi) {
+		return lo + (hi - lo) * next_float();
+	}
+	//uniform in [0,bound), without modulo bias worth worrying about (bound must be > 0):
+	uint32_t next_u32(uint32_t bound) {
+		return uint32_t(((next() >> 32) * uint64_t(bound)) >> 32);
+	}
+
+	//draw 'count' floats in [lo,hi) at once; same values as 'count' calls to next_float(lo, hi).
+	// each element depends only on its own counter, so with SSE2 four values are made per batch
+	// (two per register, with the 64-bit multiplies built from _mm_mul_epu32 32x32->64 products):
+	void fill_floats(float *out, size_t count, float lo, float hi) {
+		size_t i = 0;
+#if ZEUS_SSE2
+		const __m128i inc = _mm_set1_epi64x(int64_t(4 * 0x9e3779b97f4a7c15ULL));
+		const __m128i m1 = _mm_set1_epi64x(int64_t(0xbf58476d1ce4e5b9ULL));
+		const __m128i m2 = _mm_set1_epi64x(int64_t(0x94d049bb133111ebULL));
+		const __m128 scale = _mm_set1_ps(1.0f / 16777216.0f);
+		const __m128 lo4 = _mm_set1_ps(lo);
+		const __m128 range4 = _mm_set1_ps(hi - lo);
+		//seed + (n + 1) * golden for n = counter + [0,1] and counter + [2,3], advanced by 4 * golden per batch:
+		uint64_t z0 = seed + (counter + 1) * 0x9e3779b97f4a7c15ULL;
+		__m128i za = _mm_set_epi64x(int64_t(z0 + 0x9e3779b97f4a7c15ULL), int64_t(z0));
+		__m128i zb = _mm_set_epi64x(int64_t(z0 + 3 * 0x9e3779b97f4a7c15ULL), int64_t(z0 + 2 * 0x9e3779b97f4a7c15ULL));
+		for (; i + 4 <= count; i += 4) {
+			__m128i a = mix_sse2(za, m1, m2);
+			__m128i b = mix_sse2(zb, m1, m2);
+			//top 24 bits of each value, as four 32-bit integers in order:
+			a = _mm_shuffle_epi32(_mm_srli_epi64(a, 40), _MM_SHUFFLE(2, 0, 2, 0));
+			b = _mm_shuffle_epi32(_mm_srli_epi64(b, 40), _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 f = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi64(a, b)), scale);
+			_mm_storeu_ps(out + i, _mm_add_ps(lo4, _mm_mul_ps(range4, f)));
+			za = _mm_add_epi64(za, inc);
+			zb = _mm_add_epi64(zb, inc);
+		}
+#endif
+		for (; i < count; ++i) {
+			out[i] = lo + (hi - lo) * to_float(at(seed, counter + i));
+		}
+		counter += count;
+	}
+
+#if ZEUS_SSE2
+	//low 64 bits of a * b in each 64-bit lane:
+	static __m128i mul64_sse2(__m128i a, __m128i b) {
+		__m128i cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), b), _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+		return _mm_add_epi64(_mm_mul_epu32(a, b), _mm_slli_epi64(cross, 32));
+	}
+	//the mixing steps of at(), on two values:
+	static __m128i mix_sse2(__m128i z, __m128i m1, __m128i m2) {
+		z = mul64_sse2(_mm_xor_si128(z, _mm_srli_epi64(z, 30)), m1);
+		z = mul64_sse2(_mm_xor_si128(z, _mm_srli_epi64(z, 27)), m2);
+		return _mm_xor_si128(z, _mm_srli_epi64(z, 31));
+	}
+#endif
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+//Accumulator that turns variable frame times into a whole number of fixed simulation ticks.
+// Leftover time carries to the next frame; alpha() says how far the display
+// is between the last two ticks, for interpolating what gets drawn.
+struct FixedTimestep {
+	FixedTimestep(float tick_rate = 60.0f, uint32_t max_steps_ = 5) : tick(1.0f / tick_rate), max_steps(max_steps_) { }
+
+	float tick; //seconds per simulation step
+	uint32_t max_steps; //most steps run per frame; anything beyond is dropped (avoids a spiral of death)
+	float accumulator = 0.0f; //simulation time owed, always < tick after advance()
+
+	//add a frame's worth of real time, return the number of ticks to run:
+	uint32_t advance(float elapsed) {
+		accumulator += elapsed;
+		uint32_t steps = uint32_t(accumulator / tick);
+		if (steps > max_steps) {
+			steps = max_steps;
+			accumulator = std::min(accumulator - steps * tick, tick * 0.999f);
+		} else {
+			accumulator -= steps * tick;
+		}
+		//rounding can leave the remainder a hair outside [0,tick):
+		accumulator = std::max(0.0f, accumulator);
+		return steps;
+	}
+
+	//fraction of a tick between the last simulated state and the current display time:
+	float alpha() const {
+		return std::min(1.0f, accumulator / tick);
+	}
+};
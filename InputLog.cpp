@@ -0,0 +1,161 @@
+#include "InputLog.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+static const uint32_t InputLogMagic = 0x504e495a; //"ZINP" in little-endian
+static const uint32_t InputLogVersion = 1;
+
+//record tags (Update runs and elapsed changes get their own tags; other events use their Type):
+static const uint8_t TagUpdates = 0x80; //varint count of Update events
+static const uint8_t TagElapsed = 0x81; //4 bytes: new 'elapsed' for following Update events
+
+static void put_varint(std::vector< uint8_t > &out, uint64_t v) {
+	while (v >= 0x80) {
+		out.emplace_back(uint8_t(v) | 0x80);
+		v >>= 7;
+	}
+	out.emplace_back(uint8_t(v));
+}
+
+//small signed values to small unsigned values (0,-1,1,-2,... -> 0,1,2,3,...):
+static uint32_t zigzag(int32_t v) {
+	return (uint32_t(v) << 1) ^ uint32_t(v >> 31);
+}
+
+static int32_t unzigzag(uint64_t v) {
+	return int32_t(uint32_t(v >> 1) ^ (0U - uint32_t(v & 1)));
+}
+
+template< typename T >
+static void put_raw(std::vector< uint8_t > &out, T const &v) {
+	uint8_t bytes[sizeof(T)];
+	std::memcpy(bytes, &v, sizeof(T));
+	out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+//----- writer -----
+
+InputLogWriter::InputLogWriter(std::string const &filename, uint64_t seed, bool stress) : out(filename, std::ios::binary) {
+	if (!out) throw std::runtime_error("Failed to open input log '" + filename + "' for writing.");
+	put_raw(buffer, InputLogMagic);
+	put_raw(buffer, InputLogVersion);
+	put_raw(buffer, seed);
+	put_raw(buffer, uint8_t(stress));
+}
+
+InputLogWriter::~InputLogWriter() {
+	flush();
+}
+
+void InputLogWriter::end_run() {
+	if (updates == 0) return;
+	buffer.emplace_back(TagUpdates);
+	put_varint(buffer, updates);
+	updates = 0;
+}
+
+void InputLogWriter::write(InputEvent const &evt) {
+	if (evt.type == InputEvent::Update) {
+		if (evt.elapsed != last_elapsed) {
+			end_run();
+			buffer.emplace_back(TagElapsed);
+			put_raw(buffer, evt.elapsed);
+			last_elapsed = evt.elapsed;
+		}
+		updates += 1;
+		return;
+	}
+
+	end_run();
+	buffer.emplace_back(uint8_t(evt.type));
+	put_varint(buffer, uint32_t(evt.time - last_time));
+	last_time = evt.time;
+	if (evt.type == InputEvent::Resize) {
+		put_varint(buffer, uint32_t(evt.value.x));
+		put_varint(buffer, uint32_t(evt.value.y));
+	} else if (evt.type == InputEvent::MouseMotion) {
+		put_varint(buffer, zigzag(evt.value.x - last_mouse.x));
+		put_varint(buffer, zigzag(evt.value.y - last_mouse.y));
+		last_mouse = evt.value;
+	}
+
+	if (buffer.size() >= 64 * 1024) flush();
+}
+
+void InputLogWriter::flush() {
+	end_run();
+	out.write(reinterpret_cast< char const * >(buffer.data()), buffer.size());
+	out.flush();
+	buffer.clear();
+}
+
+//----- reader -----
+
+InputLogReader::InputLogReader(std::string const &filename) {
+	std::ifstream in(filename, std::ios::binary);
+	if (!in) throw std::runtime_error("Failed to open input log '" + filename + "'.");
+	data.assign(std::istreambuf_iterator< char >(in), std::istreambuf_iterator< char >());
+
+	uint32_t magic = 0, version = 0;
+	uint8_t stress_flag = 0;
+	const size_t header = sizeof(magic) + sizeof(version) + sizeof(seed) + sizeof(stress_flag);
+	if (data.size() < header) throw std::runtime_error("Input log '" + filename + "' is too short.");
+	std::memcpy(&magic, data.data(), sizeof(magic));
+	std::memcpy(&version, data.data() + 4, sizeof(version));
+	std::memcpy(&seed, data.data() + 8, sizeof(seed));
+	std::memcpy(&stress_flag, data.data() + 16, sizeof(stress_flag));
+	if (magic != InputLogMagic) throw std::runtime_error("'" + filename + "' is not an input log.");
+	if (version != InputLogVersion) throw std::runtime_error("Input log '" + filename + "' has unsupported version " + std::to_string(version) + ".");
+	stress = (stress_flag != 0);
+	at = header;
+}
+
+uint64_t InputLogReader::varint() {
+	uint64_t v = 0;
+	for (uint32_t shift = 0; shift < 64; shift += 7) {
+		if (at >= data.size()) throw std::runtime_error("Input log ends in the middle of a record.");
+		uint8_t b = data[at++];
+		v |= uint64_t(b & 0x7f) << shift;
+		if (!(b & 0x80)) return v;
+	}
+	throw std::runtime_error("Input log has an over-long varint.");
+}
+
+bool InputLogReader::read(InputEvent *evt) {
+	assert(evt);
+	while (updates == 0) {
+		if (at >= data.size()) return false;
+		uint8_t tag = data[at++];
+		if (tag == TagUpdates) {
+			updates = uint32_t(varint());
+		} else if (tag == TagElapsed) {
+			if (data.size() - at < sizeof(last_elapsed)) throw std::runtime_error("Input log ends in the middle of a record.");
+			std::memcpy(&last_elapsed, data.data() + at, sizeof(last_elapsed));
+			at += sizeof(last_elapsed);
+		} else if (tag >= InputEvent::Resize && tag <= InputEvent::QuickLoad) {
+			*evt = InputEvent();
+			evt->type = InputEvent::Type(tag);
+			last_time += uint32_t(varint());
+			evt->time = last_time;
+			if (tag == InputEvent::Resize) {
+				evt->value.x = int32_t(varint());
+				evt->value.y = int32_t(varint());
+			} else if (tag == InputEvent::MouseMotion) {
+				last_mouse.x += unzigzag(varint());
+				last_mouse.y += unzigzag(varint());
+				evt->value = last_mouse;
+			}
+			return true;
+		} else {
+			throw std::runtime_error("Input log has unknown record tag " + std::to_string(tag) + ".");
+		}
+	}
+	updates -= 1;
+	*evt = InputEvent();
+	evt->type = InputEvent::Update;
+	evt->elapsed = last_elapsed;
+	return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//Player input, independent of SDL, in the order the game consumed it:
+// replaying the same events against a sim built with the same seed reproduces the session exactly.
+struct InputEvent {
+	enum Type : uint8_t {
+		Update = 1, //one call to update(elapsed)
+		Resize, //window size is now 'value'
+		MouseMotion, //mouse is now at window pixel 'value'
+		MouseUp, //mouse button released (fire)
+		QuickSave, //snapshot the sim
+		QuickLoad, //rewind to the snapshot
+	};
+	Type type = Update;
+	uint32_t time = 0; //SDL event timestamp (milliseconds); not recorded for Update
+	glm::ivec2 value = glm::ivec2(0);
+	float elapsed = 0.0f; //for Update
+};
+
+//Input log file layout:
+// header: "ZINP", version, seed (u64), stress (u8)
+// then one record per event, each a tag byte followed by LEB128 varints:
+//  - event times are stored as the delta from the previous event's time;
+//  - mouse positions as zig-zag deltas from the previous mouse position;
+//  - runs of Update events as a single count, with 'elapsed' (raw float bits) only when it changes.
+struct InputLogWriter {
+	//throws on failure to open the file:
+	InputLogWriter(std::string const &filename, uint64_t seed, bool stress);
+	~InputLogWriter(); //flushes
+
+	void write(InputEvent const &evt);
+	void flush();
+
+	std::ofstream out;
+	std::vector< uint8_t > buffer; //encoded records not yet written to 'out'
+	uint32_t updates = 0; //length of the current run of Update events (not yet encoded)
+	uint32_t last_time = 0;
+	glm::ivec2 last_mouse = glm::ivec2(0);
+	float last_elapsed = 0.0f;
+
+	void end_run(); //encode the pending run of Update events
+};
+
+struct InputLogReader {
+	//reads the whole log; throws if the file can't be read or has a bad header:
+	explicit InputLogReader(std::string const &filename);
+
+	uint64_t seed = 0;
+	bool stress = false;
+
+	//decode the next event; returns false at the end of the log (throws on corrupt data):
+	bool read(InputEvent *evt);
+
+	std::vector< uint8_t > data;
+	size_t at = 0;
+	uint32_t updates = 0; //Update events left in the current run
+	uint32_t last_time = 0;
+	glm::ivec2 last_mouse = glm::ivec2(0);
+	float last_elapsed = 0.0f;
+
+	uint64_t varint(); //read one LEB128 value
+};
@@ -0,0 +1,86 @@
+#include "JobSystem.hpp"
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+JobSystem::JobSystem(uint32_t workers) {
+	threads.reserve(workers);
+	for (uint32_t i = 0; i < workers; ++i) {
+		threads.emplace_back(&JobSystem::worker, this);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::unique_lock< std::mutex > lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for (auto &t : threads) {
+		t.join();
+	}
+}
+
+uint32_t JobSystem::default_workers() {
+	uint32_t hardware = std::thread::hardware_concurrency(); //(0 if unknown)
+	return hardware > 1 ? hardware - 1 : 0;
+}
+
+void JobSystem::parallel_for(size_t count_, size_t grain_, std::function< void(size_t, size_t) > const &job_) {
+	assert(grain_ > 0);
+	if (count_ == 0) return;
+	//not worth waking anyone:
+	if (threads.empty() || count_ <= grain_) {
+		job_(0, count_);
+		return;
+	}
+
+	std::unique_lock< std::mutex > lock(mutex);
+	assert(job == nullptr && "parallel_for is not reentrant");
+	job = &job_;
+	count = count_;
+	grain = grain_;
+	chunks = (count + grain - 1) / grain;
+	next = 0;
+	finished = 0;
+	generation += 1;
+	wake.notify_all();
+
+	//help out, then wait for the workers' chunks:
+	run_chunks(lock);
+	done.wait(lock, [this](){ return finished == chunks && active == 0; });
+	//(workers that wake up late see no job, so can't pick up chunks of the next one with this one's state)
+	job = nullptr;
+}
+
+void JobSystem::run_chunks(std::unique_lock< std::mutex > &lock) {
+	std::function< void(size_t, size_t) > const &f = *job;
+	while (next < chunks) {
+		size_t chunk = next++;
+		size_t begin = chunk * grain;
+		size_t end = std::min(count, begin + grain);
+		lock.unlock();
+		{
+			PROFILE_ZONE("job");
+			f(begin, end);
+		}
+		lock.lock();
+		finished += 1;
+	}
+}
+
+void JobSystem::worker() {
+	uint64_t seen = 0;
+	std::unique_lock< std::mutex > lock(mutex);
+	while (true) {
+		wake.wait(lock, [&](){ return quit || (job != nullptr && generation != seen); });
+		if (quit) break;
+		seen = generation;
+		active += 1;
+		run_chunks(lock);
+		active -= 1;
+		if (finished == chunks && active == 0) done.notify_all();
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed pool of worker threads for data-parallel loops:
+// parallel_for(count, grain, job) splits [0,count) into chunks of at most 'grain' items and
+// runs job(begin, end) on each, using the workers and the calling thread, returning once all
+// chunks are done. Chunks run concurrently, so jobs must write disjoint outputs, must not
+// throw, and must not call OpenGL (that stays on the context thread).
+struct JobSystem {
+	//default: one worker per hardware thread, less one for the calling thread:
+	explicit JobSystem(uint32_t workers = default_workers());
+	~JobSystem();
+	JobSystem(JobSystem const &) = delete;
+	JobSystem &operator=(JobSystem const &) = delete;
+
+	static uint32_t default_workers();
+
+	void parallel_for(size_t count, size_t grain, std::function< void(size_t begin, size_t end) > const &job);
+
+	//----- internals -----
+
+	std::vector< std::thread > threads;
+
+	std::mutex mutex;
+	std::condition_variable wake; //signalled when a job is posted (or on quit)
+	std::condition_variable done; //signalled when the last chunk of a job finishes
+
+	//current job (all guarded by 'mutex'):
+	std::function< void(size_t, size_t) > const *job = nullptr; //nullptr when no job is running
+	size_t count = 0, grain = 1, chunks = 0;
+	size_t next = 0; //next unclaimed chunk
+	size_t finished = 0; //chunks completed
+	uint32_t active = 0; //workers currently running chunks of 'job'
+	uint64_t generation = 0; //incremented per job, so workers join each job at most once
+	bool quit = false;
+
+	//run chunks of the current job until none are left (call with 'lock' held; it is released while running):
+	void run_chunks(std::unique_lock< std::mutex > &lock);
+	void worker();
+};
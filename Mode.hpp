@@ -13,12 +13,14 @@ struct Mode : std::enable_shared_from_this< Mode > {
 	//The function should return 'true' if it handled the event.
 	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) { return false; }
 
-	//update is called at the start of a new frame, after events are handled:
-	// 'elapsed' is time in seconds since the last call to 'update'
+	//update is called zero or more times per frame, after events are handled:
+	// 'elapsed' is the fixed simulation tick, in seconds (see FixedTimestep.hpp)
 	virtual void update(float elapsed) { }
 
 	//draw is called after update:
-	virtual void draw(glm::uvec2 const &drawable_size) = 0;
+	// 'alpha' in [0,1] is how far display time is past the last update, in ticks;
+	// interpolate from the previous tick's state toward the current one by this much.
+	virtual void draw(glm::uvec2 const &drawable_size, float alpha) = 0;
 
 	//Mode::current is the Mode to which events are dispatched.
 	// use 'set_current' to change the current Mode (e.g., to switch to a menu)
@@ -0,0 +1,53 @@
+#include "OffscreenTarget.hpp"
+
+#include "gl_errors.hpp"
+
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+OffscreenTarget::OffscreenTarget(glm::uvec2 const &size_) : size(size_) {
+	assert(size.x > 0 && size.y > 0);
+
+	glGenRenderbuffers(1, &color_renderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, color_renderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, GLsizei(size.x), GLsizei(size.y));
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_renderbuffer);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &color_renderbuffer);
+		throw std::runtime_error("Offscreen framebuffer is incomplete (status " + std::to_string(status) + ").");
+	}
+	GL_ERRORS();
+}
+
+OffscreenTarget::~OffscreenTarget() {
+	glDeleteFramebuffers(1, &framebuffer);
+	framebuffer = 0;
+	glDeleteRenderbuffers(1, &color_renderbuffer);
+	color_renderbuffer = 0;
+}
+
+void OffscreenTarget::bind() {
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, GLsizei(size.x), GLsizei(size.y));
+}
+
+void OffscreenTarget::read(std::vector< glm::u8vec4 > *pixels) {
+	assert(pixels);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	pixels->resize(size.x * size.y);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, GLsizei(size.x), GLsizei(size.y), GL_RGBA, GL_UNSIGNED_BYTE, pixels->data());
+	for (auto &px : *pixels) {
+		px.a = 0xff;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+//Framebuffer object with an RGBA8 color renderbuffer, for drawing without a visible window
+// (e.g., on a hidden window of the "offscreen" SDL video driver, which has no usable default framebuffer):
+//
+// Per frame:  bind(); draw; (optionally) read(&pixels);
+struct OffscreenTarget {
+	//throws if the framebuffer isn't complete:
+	explicit OffscreenTarget(glm::uvec2 const &size);
+	~OffscreenTarget();
+	OffscreenTarget(OffscreenTarget const &) = delete;
+	OffscreenTarget &operator=(OffscreenTarget const &) = delete;
+
+	//bind as the draw and read framebuffer and set the viewport to cover it:
+	void bind();
+
+	//read the whole target back (lower-left origin, alpha forced to opaque); binds it first:
+	void read(std::vector< glm::u8vec4 > *pixels);
+
+	glm::uvec2 size;
+	GLuint framebuffer = 0;
+	GLuint color_renderbuffer = 0;
+};
@@ -0,0 +1,117 @@
+#include "Profiler.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILE_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_RDTSC 1
+#else
+#define PROFILE_RDTSC 0
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+	struct Event {
+		char const *name;
+		uint64_t begin, end;
+	};
+
+	//per-thread ring; only its thread writes, and 'count' is published after each event is written:
+	struct Ring {
+		explicit Ring(uint32_t tid_) : tid(tid_) { }
+		Event events[ProfileRingSize];
+		std::atomic< uint64_t > count{0};
+		uint32_t tid;
+	};
+
+	//all rings ever created (never freed, so zones from finished threads can still be written):
+	std::mutex rings_mutex;
+	std::vector< std::unique_ptr< Ring > > rings;
+
+	thread_local Ring *ring = nullptr;
+
+	uint64_t steady_ns() {
+		return uint64_t(std::chrono::duration_cast< std::chrono::nanoseconds >(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	//reference point for converting ticks to time (taken at startup):
+	struct Epoch {
+		Epoch() : ticks(profile_now()), ns(steady_ns()) { }
+		uint64_t ticks, ns;
+	};
+	Epoch const epoch;
+}
+
+uint64_t profile_now() {
+#if PROFILE_RDTSC
+	return __rdtsc();
+#else
+	return steady_ns();
+#endif
+}
+
+void profile_record(char const *name, uint64_t begin, uint64_t end) {
+	if (!ring) {
+		//first zone on this thread (the only time a lock is taken):
+		std::lock_guard< std::mutex > lock(rings_mutex);
+		rings.emplace_back(new Ring(uint32_t(rings.size())));
+		ring = rings.back().get();
+	}
+	uint64_t n = ring->count.load(std::memory_order_relaxed);
+	Event &e = ring->events[n & (ProfileRingSize - 1)];
+	e.name = name;
+	e.begin = begin;
+	e.end = end;
+	ring->count.store(n + 1, std::memory_order_release);
+}
+
+bool profile_write_chrome_trace(std::string const &filename) {
+	std::ofstream out(filename, std::ios::binary);
+	if (!out) return false;
+
+	//ticks per microsecond, measured against the steady clock since startup:
+	uint64_t now_ticks = profile_now();
+	uint64_t now_ns = steady_ns();
+	double ticks_per_us = 1e-3;
+	if (now_ns > epoch.ns && now_ticks > epoch.ticks) {
+		ticks_per_us = double(now_ticks - epoch.ticks) / (double(now_ns - epoch.ns) * 1e-3);
+	}
+	auto to_us = [&](uint64_t ticks) {
+		return double(int64_t(ticks - epoch.ticks)) / ticks_per_us;
+	};
+
+	out << std::fixed;
+	out.precision(3); //(nanosecond resolution; default precision would lose it after a few seconds)
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	std::lock_guard< std::mutex > lock(rings_mutex);
+	for (auto const &r : rings) {
+		//(ring 0 belongs to the first thread to finish a zone -- the main thread, in practice)
+		out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r->tid
+		    << ",\"args\":{\"name\":\"" << (r->tid == 0 ? "main" : "thread " + std::to_string(r->tid)) << "\"}}";
+		first = false;
+
+		uint64_t count = r->count.load(std::memory_order_acquire);
+		uint64_t oldest = (count > ProfileRingSize ? count - ProfileRingSize : 0);
+		for (uint64_t i = oldest; i < count; ++i) {
+			Event const &e = r->events[i & (ProfileRingSize - 1)];
+			out << ",\n{\"name\":\"";
+			for (char const *c = e.name; *c; ++c) {
+				if (*c == '"' || *c == '\\') out << '\\';
+				out << *c;
+			}
+			out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << r->tid
+			    << ",\"ts\":" << to_us(e.begin) << ",\"dur\":" << to_us(e.end) - to_us(e.begin) << "}";
+		}
+	}
+	out << "\n]}\n";
+	return bool(out);
+}
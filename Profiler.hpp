@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+//Scoped-zone profiler, cheap enough to leave on:
+// a zone records its start and end timestamps (the CPU's time-stamp counter where there is one)
+// into a fixed-size ring owned by the recording thread -- no locks, and no allocation after the
+// thread's first zone. profile_write_chrome_trace() converts whatever is still in the rings into
+// Chrome trace-event JSON (open in chrome://tracing or ui.perfetto.dev).
+//
+//  { PROFILE_ZONE("draw"); ... } //zone covers the rest of the scope
+//  ProfileZone zone("a"); ...; zone.next("b"); ... //back-to-back zones without extra scopes
+
+//current timestamp, in ticks (see profile_write_chrome_trace for conversion to time):
+uint64_t profile_now();
+
+//record a finished zone for the calling thread ('name' must outlive the profiler -- e.g., a string literal):
+void profile_record(char const *name, uint64_t begin, uint64_t end);
+
+//write every thread's recorded zones (at most ProfileRingSize per thread, newest kept) as JSON.
+// Call while no other thread is recording (e.g., between frames); returns false if writing failed:
+bool profile_write_chrome_trace(std::string const &filename);
+
+constexpr uint32_t ProfileRingSize = 1 << 15; //zones kept per thread
+
+struct ProfileZone {
+	explicit ProfileZone(char const *name_) : name(name_), begin(profile_now()) { }
+	~ProfileZone() { profile_record(name, begin, profile_now()); }
+	ProfileZone(ProfileZone const &) = delete;
+	ProfileZone &operator=(ProfileZone const &) = delete;
+
+	//end this zone and start another right away:
+	void next(char const *name_) {
+		uint64_t now = profile_now();
+		profile_record(name, begin, now);
+		name = name_;
+		begin = now;
+	}
+
+	char const *name;
+	uint64_t begin;
+};
+
+#define PROFILE_ZONE_JOIN2(A, B) A ## B
+#define PROFILE_ZONE_JOIN(A, B) PROFILE_ZONE_JOIN2(A, B)
+#define PROFILE_ZONE(NAME) ProfileZone PROFILE_ZONE_JOIN(profile_zone_, __LINE__)(NAME)
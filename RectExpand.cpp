@@ -0,0 +1,76 @@
+#include "RectExpand.hpp"
+
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+void expand_rects_scalar(RectInstance const *rects, size_t count, glm::vec2 const &center, glm::vec2 const &to_normalized, RectVertex *out) {
+	auto normalize = [](float x, float c, float k) {
+		return int16_t(std::max(-32767.0f, std::min(32767.0f, (x - c) * k)));
+	};
+	for (RectInstance const *r = rects; r != rects + count; ++r) {
+		int16_t x0 = normalize(r->Center.x - r->Radius.x, center.x, to_normalized.x);
+		int16_t y0 = normalize(r->Center.y - r->Radius.y, center.y, to_normalized.y);
+		int16_t x1 = normalize(r->Center.x + r->Radius.x, center.x, to_normalized.x);
+		int16_t y1 = normalize(r->Center.y + r->Radius.y, center.y, to_normalized.y);
+		new (out++) RectVertex(glm::i16vec2(x0, y0), r->Color);
+		new (out++) RectVertex(glm::i16vec2(x1, y0), r->Color);
+		new (out++) RectVertex(glm::i16vec2(x1, y1), r->Color);
+
+		new (out++) RectVertex(glm::i16vec2(x0, y0), r->Color);
+		new (out++) RectVertex(glm::i16vec2(x1, y1), r->Color);
+		new (out++) RectVertex(glm::i16vec2(x0, y1), r->Color);
+	}
+}
+
+void expand_rects(RectInstance const *rects, size_t count, glm::vec2 const &center, glm::vec2 const &to_normalized, RectVertex *out) {
+#if ZEUS_SSE2
+	//per rectangle: load (cx, cy, rx, ry), form the box (x0, y0, x1, y1) = (c - r, c + r),
+	// normalize + clamp + truncate, then pack two rectangles' boxes into eight int16 values:
+	const __m128 SIGN = _mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f);
+	const __m128 CENTER = _mm_setr_ps(center.x, center.y, center.x, center.y);
+	const __m128 SCALE = _mm_setr_ps(to_normalized.x, to_normalized.y, to_normalized.x, to_normalized.y);
+	const __m128 LO = _mm_set1_ps(-32767.0f);
+	const __m128 HI = _mm_set1_ps(32767.0f);
+	auto box = [&](RectInstance const &r) {
+		__m128 v = _mm_loadu_ps(&r.Center.x); //(cx, cy, rx, ry)
+		__m128 c = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1,0,1,0)); //(cx, cy, cx, cy)
+		__m128 e = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3,2,3,2)); //(rx, ry, rx, ry)
+		__m128 b = _mm_add_ps(c, _mm_mul_ps(e, SIGN));
+		b = _mm_mul_ps(_mm_sub_ps(b, CENTER), SCALE);
+		return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(b, LO), HI));
+	};
+	//one rectangle's six vertices, as three 16-byte stores of (position, color) pairs:
+	// P holds (x0, y0, x1, y1) in its low four int16 lanes.
+	auto emit = [](__m128i P, uint32_t color, RectVertex *dst) {
+		__m128i C = _mm_set1_epi32(int32_t(color));
+		__m128i A = _mm_shufflelo_epi16(P, _MM_SHUFFLE(1,2,1,0)); //(x0,y0), (x1,y0)
+		__m128i B = _mm_shufflelo_epi16(P, _MM_SHUFFLE(1,0,3,2)); //(x1,y1), (x0,y0)
+		__m128i D = _mm_shufflelo_epi16(P, _MM_SHUFFLE(3,0,3,2)); //(x1,y1), (x0,y1)
+		__m128i *d = reinterpret_cast< __m128i * >(dst);
+		_mm_storeu_si128(d + 0, _mm_unpacklo_epi32(A, C));
+		_mm_storeu_si128(d + 1, _mm_unpacklo_epi32(B, C));
+		_mm_storeu_si128(d + 2, _mm_unpacklo_epi32(D, C));
+	};
+	auto color_bits = [](RectInstance const &r) {
+		uint32_t c;
+		std::memcpy(&c, &r.Color, sizeof(c));
+		return c;
+	};
+
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2) {
+		__m128i P = _mm_packs_epi32(box(rects[i]), box(rects[i+1]));
+		emit(P, color_bits(rects[i]), out + 6 * i);
+		emit(_mm_srli_si128(P, 8), color_bits(rects[i+1]), out + 6 * (i + 1));
+	}
+	if (i < count) {
+		__m128i P = _mm_packs_epi32(box(rects[i]), _mm_setzero_si128());
+		emit(P, color_bits(rects[i]), out + 6 * i);
+	}
+#else
+	expand_rects_scalar(rects, count, center, to_normalized, out);
+#endif
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+//Rectangle batches for drawing (no OpenGL here, so kernels can be benchmarked headless).
+
+//Axis-aligned rectangle, as collected by ZeusMode::draw (and uploaded as-is when drawing instanced):
+struct RectInstance {
+	RectInstance() = default;
+	RectInstance(glm::vec2 const &Center_, glm::vec2 const &Radius_, glm::u8vec4 const &Color_) :
+		Center(Center_), Radius(Radius_), Color(Color_) { }
+	glm::vec2 Center;
+	glm::vec2 Radius;
+	glm::u8vec4 Color;
+};
+static_assert(sizeof(RectInstance) == 4*2 + 4*2 + 1*4, "RectInstance should be packed");
+
+//Compact vertex: position as 16-bit values normalized to some area (see expand_rects), plus color:
+struct RectVertex {
+	RectVertex(glm::i16vec2 const &Position_, glm::u8vec4 const &Color_) :
+		Position(Position_), Color(Color_) { }
+	glm::i16vec2 Position;
+	glm::u8vec4 Color;
+};
+static_assert(sizeof(RectVertex) == 2*2 + 1*4, "RectVertex should be packed");
+
+//Expand 'count' rectangles into two CCW-oriented triangles (6 vertices) each, written to 'out'.
+// Positions are stored as (p - center) * to_normalized, clamped to [-32767,32767] and truncated,
+// so to_normalized = 32767 / (radius of the area) maps that area to the full 16-bit range.
+// 'out' is only written (never read), so it may point into write-combined mapped GPU memory.
+void expand_rects(RectInstance const *rects, size_t count, glm::vec2 const &center, glm::vec2 const &to_normalized, RectVertex *out);
+
+//Same results, one rectangle at a time without SIMD (reference for expand_rects):
+void expand_rects_scalar(RectInstance const *rects, size_t count, glm::vec2 const &center, glm::vec2 const &to_normalized, RectVertex *out);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "GL.hpp"
+
+//Shader program that draws axis-aligned, solid-colored rectangles, one instance per rectangle:
+// each instance supplies (Center, Radius, Color); the vertex shader expands it into
+// a four-vertex triangle strip, so draw with glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count).
+struct RectInstanceProgram {
+	RectInstanceProgram();
+	~RectInstanceProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-instance variable) locations:
+	GLuint Center_vec2 = -1U;
+	GLuint Radius_vec2 = -1U;
+	GLuint Color_vec4 = -1U;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+};
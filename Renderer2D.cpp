@@ -0,0 +1,331 @@
+#include "Renderer2D.hpp"
+
+#include "gl_errors.hpp"
+#include "gl_call_count.hpp"
+#include "Profiler.hpp"
+
+//for glm::value_ptr() :
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+Renderer2D::Batch::Batch() {
+	glGenBuffers(1, &buffer);
+}
+
+Renderer2D::Batch::~Batch() {
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+Renderer2D::Renderer2D() {
+	{ //vertex array mapping instance_stream (one element per instance) to rect_instance_program:
+		glGenVertexArrays(1, &instance_buffer_for_rect_instance_program);
+		glBindVertexArray(instance_buffer_for_rect_instance_program);
+		glBindBuffer(GL_ARRAY_BUFFER, instance_stream.buffer);
+
+		point_instance_attributes(0);
+		glEnableVertexAttribArray(rect_instance_program.Center_vec2);
+		glEnableVertexAttribArray(rect_instance_program.Radius_vec2);
+		glEnableVertexAttribArray(rect_instance_program.Color_vec4);
+
+		//every attribute advances once per instance (divisor 1), not once per vertex:
+		glVertexAttribDivisor(rect_instance_program.Center_vec2, 1);
+		glVertexAttribDivisor(rect_instance_program.Radius_vec2, 1);
+		glVertexAttribDivisor(rect_instance_program.Color_vec4, 1);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+	}
+
+	{ //vertex array mapping vertex_stream to color_program:
+		glGenVertexArrays(1, &vertex_buffer_for_color_program);
+		glBindVertexArray(vertex_buffer_for_color_program);
+		glBindBuffer(GL_ARRAY_BUFFER, vertex_stream.buffer);
+
+		point_vertex_attributes(0);
+		glEnableVertexAttribArray(color_program.Position_vec4);
+		glEnableVertexAttribArray(color_program.Color_vec4);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+	}
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+Renderer2D::~Renderer2D() {
+	glDeleteVertexArrays(1, &instance_buffer_for_rect_instance_program);
+	instance_buffer_for_rect_instance_program = 0;
+
+	glDeleteVertexArrays(1, &vertex_buffer_for_color_program);
+	vertex_buffer_for_color_program = 0;
+}
+
+void Renderer2D::point_vertex_attributes(GLintptr offset) {
+	GL_COUNTED(glVertexAttribPointer(
+		color_program.Position_vec4, //attribute
+		2, //size
+		GL_SHORT, //type
+		GL_TRUE, //normalized
+		sizeof(RectVertex), //stride
+		(GLbyte *)0 + offset + 0 //offset
+	));
+	//[Note that it is okay to bind a vec2 input to a vec4 attribute -- z and w will be filled with 0.0 and 1.0 automatically]
+
+	GL_COUNTED(glVertexAttribPointer(
+		color_program.Color_vec4, //attribute
+		4, //size
+		GL_UNSIGNED_BYTE, //type
+		GL_TRUE, //normalized
+		sizeof(RectVertex), //stride
+		(GLbyte *)0 + offset + 2*2 //offset
+	));
+}
+
+void Renderer2D::point_instance_attributes(GLintptr offset) {
+	GL_COUNTED(glVertexAttribPointer(
+		rect_instance_program.Center_vec2, //attribute
+		2, //size
+		GL_FLOAT, //type
+		GL_FALSE, //normalized
+		sizeof(RectInstance), //stride
+		(GLbyte *)0 + offset + 0 //offset
+	));
+
+	GL_COUNTED(glVertexAttribPointer(
+		rect_instance_program.Radius_vec2, //attribute
+		2, //size
+		GL_FLOAT, //type
+		GL_FALSE, //normalized
+		sizeof(RectInstance), //stride
+		(GLbyte *)0 + offset + 4*2 //offset
+	));
+
+	GL_COUNTED(glVertexAttribPointer(
+		rect_instance_program.Color_vec4, //attribute
+		4, //size
+		GL_UNSIGNED_BYTE, //type
+		GL_TRUE, //normalized
+		sizeof(RectInstance), //stride
+		(GLbyte *)0 + offset + 4*2 + 4*2 //offset
+	));
+}
+
+void Renderer2D::begin(glm::mat4 const &world_to_clip_, glm::vec2 const &area_min_, glm::vec2 const &area_max_) {
+	world_to_clip = world_to_clip_;
+	area_min = area_min_;
+	area_max = area_max_;
+	commands.clear();
+	rects.clear();
+	customs.clear();
+}
+
+void Renderer2D::rect(Key const &key, glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color) {
+	uint64_t packed = key.packed();
+	uint32_t index = uint32_t(rects.size());
+	rects.emplace_back(center, radius, color);
+	//extend the previous submission if it ends right here with the same key:
+	if (!commands.empty()) {
+		Command &last = commands.back();
+		if (last.key == packed && last.batch == nullptr && last.custom == -1U && last.first + last.count == index) {
+			last.count += 1;
+			return;
+		}
+	}
+	commands.emplace_back(Command{ packed, nullptr, index, 1, -1U, uint32_t(commands.size()) });
+}
+
+void Renderer2D::batch(Key const &key, Batch &batch, uint32_t first, uint32_t count) {
+	assert(size_t(first) + count <= batch.rects.size());
+	if (count == 0) return;
+	commands.emplace_back(Command{ key.packed(), &batch, first, count, -1U, uint32_t(commands.size()) });
+}
+
+void Renderer2D::custom(Key const &key, std::function< void(glm::mat4 const &) > const &draw) {
+	commands.emplace_back(Command{ key.packed(), nullptr, 0, 0, uint32_t(customs.size()), uint32_t(commands.size()) });
+	customs.emplace_back(draw);
+}
+
+void Renderer2D::flush() {
+	ProfileZone phase("flush: sort");
+	stats = Stats();
+	uint64_t gl_calls_before = gl_call_count();
+
+	//order by key; equal keys keep submission order (painter's order within a key):
+	// (sorting in place on (key, seq) -- std::stable_sort would allocate a buffer every frame)
+	std::sort(commands.begin(), commands.end(), [](Command const &a, Command const &b) {
+		return a.key < b.key || (a.key == b.key && a.seq < b.seq);
+	});
+
+	//streamed rectangles go to this frame's stream region in sorted order, so that same-key
+	// submissions end up adjacent; afterward, 'first' is a position in the stream region
+	// (and when expanding on the CPU, everything is streamed, so 'batch' no longer matters):
+	pieces.clear();
+	for (Command &c : commands) {
+		if (c.custom != -1U) continue;
+		if (instanced && c.batch) continue;
+		uint32_t out = pieces.empty() ? 0 : pieces.back().out + pieces.back().count;
+		pieces.emplace_back(Piece{ (c.batch ? c.batch->rects.data() : rects.data()) + c.first, c.count, out });
+		c.first = out;
+		if (!instanced) c.batch = nullptr;
+	}
+	//rectangles (instanced) or rectangles-to-expand (CPU) in this frame's stream region:
+	size_t stream_count = pieces.empty() ? 0 : pieces.back().out + pieces.back().count;
+
+	//call work(src, count, out) for every streamed rectangle, in chunks spread over 'jobs' (if set):
+	auto for_pieces = [this, stream_count](auto &&work) {
+		auto run = [&](size_t begin, size_t end) {
+			//find the piece containing 'begin' (the last one starting at or before it):
+			auto piece = std::upper_bound(pieces.begin(), pieces.end(), begin, [](size_t at, Piece const &p) {
+				return at < p.out;
+			}) - 1;
+			while (begin < end) {
+				size_t skip = begin - piece->out;
+				size_t n = std::min(end - begin, piece->count - skip);
+				work(piece->src + skip, n, begin);
+				begin += n;
+				++piece;
+			}
+		};
+		if (jobs) jobs->parallel_for(stream_count, job_grain, run);
+		else run(0, stream_count);
+	};
+
+	phase.next(instanced ? "flush: stream rects" : "flush: expand rects");
+	GLintptr stream_offset = 0;
+	if (stream_count) {
+		if (instanced) {
+			RectInstance *out = reinterpret_cast< RectInstance * >(instance_stream.map(stream_count * sizeof(RectInstance), &stream_offset));
+			for_pieces([out](RectInstance const *src, size_t count, size_t at) {
+				std::copy(src, src + count, out + at);
+			});
+			instance_stream.unmap(stream_count * sizeof(RectInstance));
+			stats.bytes_uploaded += stream_count * sizeof(RectInstance);
+		} else {
+			//positions are stored as 16-bit values normalized to the visible area (clamped, which is
+			// harmless for axis-aligned rectangles -- anything cut off was off-screen anyway):
+			glm::vec2 center = 0.5f * (area_max + area_min);
+			glm::vec2 to_normalized = glm::vec2(32767.0f) / (0.5f * (area_max - area_min));
+			RectVertex *out = reinterpret_cast< RectVertex * >(vertex_stream.map(6 * stream_count * sizeof(RectVertex), &stream_offset));
+			for_pieces([out, &center, &to_normalized](RectInstance const *src, size_t count, size_t at) {
+				expand_rects(src, count, center, to_normalized, out + 6 * at);
+			});
+			vertex_stream.unmap(6 * stream_count * sizeof(RectVertex));
+			stats.bytes_uploaded += 6 * stream_count * sizeof(RectVertex);
+		}
+	}
+
+	//upload batches that changed:
+	phase.next("flush: draw");
+	if (instanced) {
+		for (Command const &c : commands) {
+			if (!c.batch || c.batch->uploaded) continue;
+			GL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, c.batch->buffer));
+			GL_COUNTED(glBufferData(GL_ARRAY_BUFFER, c.batch->rects.size() * sizeof(RectInstance), c.batch->rects.data(), GL_DYNAMIC_DRAW));
+			c.batch->uploaded = true;
+			stats.bytes_uploaded += c.batch->rects.size() * sizeof(RectInstance);
+		}
+		GL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	}
+
+	//merge same-key submissions that are adjacent in the same buffer into single draws:
+	size_t runs = 0;
+	for (Command const &c : commands) {
+		if (runs > 0) {
+			Command &run = commands[runs-1];
+			if (c.custom == -1U && run.custom == -1U && c.key == run.key && c.batch == run.batch && run.first + run.count == c.first) {
+				run.count += c.count;
+				continue;
+			}
+		}
+		commands[runs++] = c;
+	}
+	commands.resize(runs);
+
+	//---- draw ----
+
+	GL_COUNTED(glDisable(GL_DEPTH_TEST));
+	GL_COUNTED(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+	//state is only changed between runs that need it changed:
+	int32_t blend = -1; //current Blend (-1: unknown)
+	bool bound = false; //rectangle program + vertex array are bound
+
+	glm::mat4 normalized_to_clip;
+	if (!instanced) {
+		//normalized positions are relative to the area's center, in units of its radius:
+		glm::vec2 center = 0.5f * (area_max + area_min);
+		glm::vec2 radius = 0.5f * (area_max - area_min);
+		normalized_to_clip = glm::mat4(
+			world_to_clip[0] * radius.x,
+			world_to_clip[1] * radius.y,
+			world_to_clip[2],
+			world_to_clip * glm::vec4(center, 0.0f, 1.0f)
+		);
+	}
+
+	for (Command const &c : commands) {
+		Blend want = Blend((c.key >> 8) & 0xff);
+		if (int32_t(want) != blend) {
+			if (want == Alpha) GL_COUNTED(glEnable(GL_BLEND));
+			else GL_COUNTED(glDisable(GL_BLEND));
+			blend = int32_t(want);
+		}
+
+		if (c.custom != -1U) {
+			if (bound) {
+				GL_COUNTED(glBindVertexArray(0));
+				GL_COUNTED(glUseProgram(0));
+				bound = false;
+			}
+			customs[c.custom](world_to_clip);
+			stats.draw_calls += 1;
+			continue;
+		}
+
+		if (instanced) {
+			if (!bound) {
+				GL_COUNTED(glUseProgram(rect_instance_program.program));
+				GL_COUNTED(glUniformMatrix4fv(rect_instance_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(world_to_clip)));
+				GL_COUNTED(glBindVertexArray(instance_buffer_for_rect_instance_program));
+				bound = true;
+			}
+			//four strip vertices per rectangle, expanded in the vertex shader (instances draw in order, so layering is kept):
+			GL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, c.batch ? c.batch->buffer : instance_stream.buffer));
+			point_instance_attributes((c.batch ? 0 : stream_offset) + GLintptr(c.first * sizeof(RectInstance)));
+			GL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, 0));
+			GL_COUNTED(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(c.count)));
+			stats.vertices += 4 * c.count;
+		} else {
+			if (!bound) {
+				GL_COUNTED(glUseProgram(color_program.program));
+				GL_COUNTED(glUniformMatrix4fv(color_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(normalized_to_clip)));
+				GL_COUNTED(glBindVertexArray(vertex_buffer_for_color_program));
+				GL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, vertex_stream.buffer));
+				point_vertex_attributes(stream_offset);
+				GL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, 0));
+				bound = true;
+			}
+			//two triangles per rectangle:
+			GL_COUNTED(glDrawArrays(GL_TRIANGLES, GLint(6 * c.first), GLsizei(6 * c.count)));
+			stats.vertices += 6 * c.count;
+		}
+		stats.draw_calls += 1;
+		stats.rects += c.count;
+	}
+
+	if (bound) {
+		GL_COUNTED(glBindVertexArray(0));
+		GL_COUNTED(glUseProgram(0));
+	}
+
+	if (stream_count) {
+		if (instanced) instance_stream.fence();
+		else vertex_stream.fence();
+	}
+	stats.gl_calls = uint32_t(gl_call_count() - gl_calls_before);
+
+	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
+}
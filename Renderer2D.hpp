@@ -0,0 +1,136 @@
+#pragma once
+
+#include "RectExpand.hpp"
+#include "RectInstanceProgram.hpp"
+#include "ColorProgram.hpp"
+#include "StreamBuffer.hpp"
+#include "JobSystem.hpp"
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+//Batched 2D renderer:
+// a mode submits solid rectangles (one at a time, or from Batches that stay on the GPU
+// between frames) and custom draws, each tagged with a sort Key. flush() sorts the frame's
+// submissions by key -- ties broken by submission order -- and draws each run of
+// same-key rectangles with as few draw calls as it can, changing GL state only between runs.
+//
+// Per frame:  begin(world_to_clip, area_min, area_max); rect(...) / batch(...) / custom(...); flush();
+struct Renderer2D {
+	Renderer2D();
+	~Renderer2D();
+
+	enum Blend : uint8_t {
+		Opaque = 0, //no blending (sorts first, so opaque things in a layer draw before translucent ones)
+		Alpha = 1, //src * src.a + dst * (1 - src.a)
+	};
+
+	//program ids for Key::program (so submissions that share a program sort next to each other):
+	enum Program : uint8_t {
+		RectProgramId = 0, //the built-in rectangle program (rect() and batch())
+		TrailProgramId = 1, //ZeusMode's trail (a custom draw)
+	};
+
+	//submissions draw ordered by (layer, blend, program), then in submission order:
+	struct Key {
+		Key(uint16_t layer_ = 0, Blend blend_ = Alpha, Program program_ = RectProgramId) :
+			layer(layer_), blend(blend_), program(program_) { }
+		uint16_t layer;
+		Blend blend;
+		Program program;
+		uint64_t packed() const {
+			return (uint64_t(layer) << 16) | (uint64_t(blend) << 8) | uint64_t(program);
+		}
+	};
+
+	//Rectangles kept between frames; uploaded (when instanced) only after changed():
+	struct Batch {
+		Batch();
+		~Batch();
+		Batch(Batch const &) = delete;
+		Batch &operator=(Batch const &) = delete;
+
+		std::vector< RectInstance > rects;
+		void changed() { uploaded = false; } //call after modifying 'rects'
+
+		GLuint buffer = 0; //copy of 'rects' for instanced drawing
+		bool uploaded = false;
+	};
+
+	//if true, rectangles are expanded into triangle strips by rect_instance_program on the GPU;
+	// otherwise they are expanded into RectVertex on the CPU (expand_rects) and drawn with color_program:
+	bool instanced = true;
+
+	//if set, flush() splits its CPU-side rectangle work (copying into the instance stream, or
+	// expanding into vertices) into chunks of job_grain rectangles that run on these workers,
+	// each writing its own range of the mapped stream region; all GL calls stay on this thread:
+	JobSystem *jobs = nullptr;
+	static constexpr size_t job_grain = 4096;
+
+	//start a frame. world_to_clip maps submitted coordinates to clip space; [area_min, area_max] is
+	// the visible area (the CPU path stores positions as 16-bit values normalized to it, clamping the rest):
+	void begin(glm::mat4 const &world_to_clip, glm::vec2 const &area_min, glm::vec2 const &area_max);
+
+	//submit one rectangle:
+	void rect(Key const &key, glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color);
+	//submit rectangles [first, first + count) of a batch (which must outlive flush()):
+	void batch(Key const &key, Batch &batch, uint32_t first, uint32_t count);
+	//submit a custom draw; 'draw' is called with blending set for key.blend and must leave no
+	// program or vertex array bound:
+	void custom(Key const &key, std::function< void(glm::mat4 const &world_to_clip) > const &draw);
+
+	//sort and draw everything submitted since begin():
+	void flush();
+
+	//what the last flush() did:
+	struct Stats {
+		uint32_t draw_calls = 0;
+		uint32_t rects = 0; //rectangles drawn (including from batches)
+		uint32_t vertices = 0; //vertices processed (strip vertices when instanced)
+		uint64_t bytes_uploaded = 0; //streamed rectangles or vertices, plus re-uploaded batches
+		uint32_t gl_calls = 0; //GL_COUNTED calls made during flush() (its own, its stream buffers', and any in custom draws)
+	};
+	Stats stats;
+
+	//----- internals -----
+
+	struct Command {
+		uint64_t key;
+		Batch *batch; //nullptr for rectangles from 'rects' (or a custom draw)
+		uint32_t first, count; //range of 'rects' or of batch->rects
+		uint32_t custom; //index into 'customs', or -1U
+		uint32_t seq; //submission order (breaks ties between equal keys)
+	};
+	std::vector< Command > commands; //submissions for this frame
+	std::vector< RectInstance > rects; //rectangles submitted one at a time (kept across frames to avoid reallocating)
+	std::vector< std::function< void(glm::mat4 const &) > > customs;
+
+	//a run of source rectangles and where it goes in the stream region (in rectangles):
+	struct Piece {
+		RectInstance const *src;
+		uint32_t count;
+		uint32_t out;
+	};
+	std::vector< Piece > pieces; //this frame's streamed rectangles, in sorted order
+
+	glm::mat4 world_to_clip;
+	glm::vec2 area_min, area_max;
+
+	//Shader program and vertex array for instanced rectangles, fed from instance_stream or batch buffers:
+	RectInstanceProgram rect_instance_program;
+	StreamBuffer instance_stream;
+	GLuint instance_buffer_for_rect_instance_program = 0;
+
+	//Shader program and vertex array for CPU-expanded rectangles, fed from vertex_stream:
+	ColorProgram color_program;
+	StreamBuffer vertex_stream;
+	GLuint vertex_buffer_for_color_program = 0;
+
+	//point the bound vertex array's attributes at data starting 'offset' bytes into the bound GL_ARRAY_BUFFER:
+	void point_vertex_attributes(GLintptr offset);
+	void point_instance_attributes(GLintptr offset);
+};
@@ -0,0 +1,174 @@
+#include "Screenshots.hpp"
+
+#include "load_save_png.hpp"
+#include "gl_errors.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+Screenshots::Screenshots() {
+	writer = std::thread(&Screenshots::write_pngs, this);
+}
+
+Screenshots::~Screenshots() {
+	{
+		std::unique_lock< std::mutex > lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	writer.join();
+
+	for (auto &slot : slots) {
+		if (slot->fence) glDeleteSync(slot->fence);
+		if (slot->state == Slot::Mapped) {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glDeleteBuffers(1, &slot->buffer);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slots.clear();
+}
+
+void Screenshots::request(std::string const &filename) {
+	requested = filename;
+}
+
+void Screenshots::capture(GLuint framebuffer, GLenum buffer, glm::uvec2 const &size) {
+	if (requested.empty() || size.x == 0 || size.y == 0) return;
+
+	//find a free slot:
+	Slot *slot = nullptr;
+	for (auto &s : slots) {
+		if (s->state == Slot::Free) {
+			slot = s.get();
+			break;
+		}
+	}
+	if (!slot) {
+		slots.emplace_back(new Slot);
+		slot = slots.back().get();
+		glGenBuffers(1, &slot->buffer);
+	}
+
+	slot->filename = requested;
+	slot->size = size;
+	requested.clear();
+
+	//read into the pixel buffer object; glReadPixels returns without waiting for the frame to finish:
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+	GLsizeiptr bytes = GLsizeiptr(size.x) * size.y * sizeof(glm::u8vec4);
+	if (bytes != slot->buffer_size) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+		slot->buffer_size = bytes;
+	}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glReadBuffer(buffer);
+	glReadPixels(0, 0, GLsizei(size.x), GLsizei(size.y), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot->state = Slot::Reading;
+
+	GL_ERRORS();
+}
+
+void Screenshots::poll() {
+	bool queued = false;
+	for (auto &s : slots) {
+		Slot &slot = *s;
+		if (slot.state == Slot::Reading) {
+			//(a zero timeout just checks the fence)
+			GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			if (status == GL_WAIT_FAILED) throw std::runtime_error("glClientWaitSync failed on a screenshot fence.");
+			if (status == GL_TIMEOUT_EXPIRED) continue;
+			glDeleteSync(slot.fence);
+			slot.fence = 0;
+
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+			slot.pixels = reinterpret_cast< glm::u8vec4 const * >(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.buffer_size, GL_MAP_READ_BIT));
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			if (!slot.pixels) throw std::runtime_error("glMapBufferRange failed on a screenshot buffer.");
+
+			slot.state = Slot::Mapped;
+			std::unique_lock< std::mutex > lock(mutex);
+			slot.copied = false;
+			queue.emplace_back(&slot);
+			queued = true;
+		} else if (slot.state == Slot::Mapped) {
+			{
+				std::unique_lock< std::mutex > lock(mutex);
+				if (!slot.copied) continue;
+			}
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			slot.pixels = nullptr;
+			slot.state = Slot::Free;
+		}
+	}
+	if (queued) wake.notify_one();
+}
+
+void Screenshots::finish() {
+	glFinish();
+	while (true) {
+		poll();
+		bool reading = false, mapped = false;
+		for (auto &s : slots) {
+			if (s->state == Slot::Reading) reading = true;
+			if (s->state == Slot::Mapped) mapped = true;
+		}
+		if (!reading && !mapped) break;
+		if (!mapped) continue; //(after glFinish(), fences are signalled by the next poll())
+		//wait for the writer thread to copy something:
+		std::unique_lock< std::mutex > lock(mutex);
+		idle.wait(lock, [this](){
+			for (auto &s : slots) {
+				if (s->state == Slot::Mapped && s->copied) return true;
+			}
+			return false;
+		});
+	}
+	std::unique_lock< std::mutex > lock(mutex);
+	idle.wait(lock, [this](){ return queue.empty() && writing == 0; });
+}
+
+void Screenshots::write_pngs() {
+	std::unique_lock< std::mutex > lock(mutex);
+	while (true) {
+		wake.wait(lock, [this](){ return quit || !queue.empty(); });
+		if (queue.empty()) break; //(quit, with nothing left to write)
+
+		Slot *slot = queue.front();
+		queue.pop_front();
+		writing += 1;
+		std::string filename = slot->filename;
+		glm::uvec2 size = slot->size;
+		glm::u8vec4 const *pixels = slot->pixels;
+		lock.unlock();
+
+		//copy out of the mapping (which is read-only) with alpha forced to opaque:
+		std::vector< glm::u8vec4 > data(pixels, pixels + size.x * size.y);
+		for (auto &px : data) {
+			px.a = 0xff;
+		}
+
+		lock.lock();
+		slot->copied = true;
+		lock.unlock();
+		idle.notify_all();
+
+		try {
+			save_png(filename, size, data.data(), LowerLeftOrigin);
+			std::cout << "Saved screenshot to '" << filename << "'." << std::endl;
+		} catch (std::exception const &e) {
+			std::cerr << "Failed to save screenshot to '" << filename << "': " << e.what() << std::endl;
+		}
+
+		lock.lock();
+		writing -= 1;
+		idle.notify_all();
+	}
+}
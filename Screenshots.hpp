@@ -0,0 +1,72 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Screenshots that never stall the frame loop:
+// capture() starts an asynchronous glReadPixels into a pixel buffer object and fences it;
+// poll() (once a frame) maps readbacks whose fence has signalled -- usually a frame or two later --
+// and hands the mapped pixels to a writer thread, which copies them out (forcing alpha to opaque),
+// so the buffer can be unmapped and reused, then encodes and saves the PNG.
+//
+// Per frame:  draw; capture(framebuffer, buffer, size); swap; poll();
+struct Screenshots {
+	Screenshots();
+	~Screenshots(); //waits for the writer thread; call finish() first (while the GL context exists) to save in-flight captures
+	Screenshots(Screenshots const &) = delete;
+	Screenshots &operator=(Screenshots const &) = delete;
+
+	//capture the next frame passed to capture() into 'filename':
+	void request(std::string const &filename);
+
+	//if a capture was requested, start reading 'buffer' (e.g., GL_BACK, or GL_COLOR_ATTACHMENT0) of 'framebuffer':
+	void capture(GLuint framebuffer, GLenum buffer, glm::uvec2 const &size);
+
+	//move finished readbacks along (never waits on the GPU or the writer thread):
+	void poll();
+
+	//block until every capture so far is saved:
+	void finish();
+
+	//----- internals -----
+
+	//a pixel buffer object and the capture using it:
+	struct Slot {
+		enum State {
+			Free, //'buffer' is unused
+			Reading, //readback in flight; 'fence' signals when it's done
+			Mapped, //'pixels' points into 'buffer', for the writer thread to copy out
+		};
+		State state = Free; //(only used on the GL thread)
+		bool copied = false; //the writer thread is done with 'pixels', so poll() can unmap (guarded by 'mutex')
+		GLuint buffer = 0;
+		GLsizeiptr buffer_size = 0;
+		GLsync fence = 0;
+		std::string filename;
+		glm::uvec2 size = glm::uvec2(0);
+		glm::u8vec4 const *pixels = nullptr;
+	};
+	std::vector< std::unique_ptr< Slot > > slots;
+
+	std::string requested; //filename for the next capture() (empty if none)
+
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable wake; //signalled when a slot is queued (or on quit)
+	std::condition_variable idle; //signalled when the writer thread finishes a slot
+	std::deque< Slot * > queue; //Mapped slots waiting for the writer thread (guarded by 'mutex')
+	uint32_t writing = 0; //slots taken from 'queue' whose PNG isn't saved yet (guarded by 'mutex')
+	bool quit = false;
+
+	void write_pngs();
+};
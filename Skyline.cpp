@@ -0,0 +1,74 @@
+#include "Skyline.hpp"
+
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+Skyline::Skyline(float min_x_, float max_x_, float column_width_, float floor_y_, float quantum_) :
+	min_x(min_x_), column_width(column_width_), floor_y(floor_y_), quantum(quantum_) {
+	assert(column_width > 0.0f && quantum > 0.0f);
+	columns = std::max(1U, uint32_t(std::floor((max_x_ - min_x_) / column_width)));
+	heights.assign((columns + 7) / 8 * 8, 0);
+}
+
+uint32_t Skyline::column(float x) const {
+	int32_t c = int32_t(std::floor((x - min_x) / column_width));
+	return uint32_t(std::min(std::max(c, 0), int32_t(columns) - 1));
+}
+
+bool Skyline::spawn(uint32_t c) {
+	assert(c < columns);
+	if (heights[c] != 0) return false;
+	heights[c] = 1;
+	standing += 1;
+	return true;
+}
+
+void Skyline::grow(uint16_t steps) {
+#if ZEUS_SSE2
+	__m128i ZERO = _mm_setzero_si128();
+	__m128i STEPS = _mm_set1_epi16(int16_t(steps));
+	for (size_t i = 0; i < heights.size(); i += 8) {
+		__m128i h = _mm_loadu_si128(reinterpret_cast< __m128i const * >(&heights[i]));
+		//only standing buildings grow; empty lots stay empty:
+		__m128i add = _mm_andnot_si128(_mm_cmpeq_epi16(h, ZERO), STEPS);
+		_mm_storeu_si128(reinterpret_cast< __m128i * >(&heights[i]), _mm_adds_epu16(h, add));
+	}
+#else
+	for (auto &h : heights) {
+		if (h != 0) h = uint16_t(std::min< uint32_t >(0xffff, uint32_t(h) + steps));
+	}
+#endif
+}
+
+bool Skyline::hit(glm::vec2 const &lo, glm::vec2 const &hi, uint32_t *c0, uint32_t *c1, float *tallest) const {
+	assert(c0 && c1 && tallest);
+	uint32_t first = column(lo.x);
+	uint32_t last = column(hi.x);
+	//boxes entirely past either end of the city can't hit anything:
+	if (hi.x < min_x || lo.x >= min_x + columns * column_width) return false;
+
+	//compare in whole 'quantum' steps to avoid converting every height:
+	float reach = (lo.y - floor_y) / quantum;
+	uint16_t best = 0;
+	bool found = false;
+	for (uint32_t c = first; c <= last; ++c) {
+		if (heights[c] == 0 || float(heights[c]) < reach) continue;
+		if (!found) *c0 = c;
+		*c1 = c;
+		found = true;
+		best = std::max(best, heights[c]);
+	}
+	if (found) *tallest = floor_y + best * quantum;
+	return found;
+}
+
+void Skyline::clear(uint32_t c0, uint32_t c1) {
+	assert(c0 <= c1 && c1 < columns);
+	for (uint32_t c = c0; c <= c1; ++c) {
+		if (heights[c] != 0) standing -= 1;
+		heights[c] = 0;
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+//Ground-anchored city stored as a 1D height field:
+// the x range is split into equal-width columns, and each column stores its
+// height as a whole number of 'quantum' steps above 'floor_y' (0 == empty lot).
+// Hit tests and growth are lookups/adds on the height array rather than per-building box tests.
+struct Skyline {
+	Skyline(float min_x, float max_x, float column_width, float floor_y, float quantum);
+
+	//column containing x (clamped to the valid range):
+	uint32_t column(float x) const;
+	float column_center(uint32_t c) const { return min_x + (c + 0.5f) * column_width; }
+	float top(uint32_t c) const { return floor_y + heights[c] * quantum; }
+
+	//start a building one quantum tall on an empty lot; returns false if the lot was taken:
+	bool spawn(uint32_t c);
+
+	//raise every standing building by 'steps' quanta (saturating, SSE2 when available):
+	void grow(uint16_t steps);
+
+	//find the standing columns under the x extent of [lo,hi] whose tops reach lo.y:
+	// on a hit, fills the column range [*c0,*c1] and the tallest top in that range.
+	bool hit(glm::vec2 const &lo, glm::vec2 const &hi, uint32_t *c0, uint32_t *c1, float *tallest) const;
+
+	//knock down columns [c0,c1]:
+	void clear(uint32_t c0, uint32_t c1);
+
+	float min_x;
+	float column_width;
+	float floor_y;
+	float quantum;
+	uint32_t columns;
+	uint32_t standing = 0; //number of non-empty columns
+
+	std::vector< uint16_t > heights; //padded to a multiple of 8 so grow() can run full SIMD batches
+};
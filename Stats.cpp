@@ -0,0 +1,89 @@
+#include "Stats.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+	struct Entry {
+		StatCounter *counter;
+		double history[StatsWindow]; //ring of past frames' values
+	};
+
+	//(constructed on first use, so StatCounters in any translation unit can register during static initialization)
+	std::vector< Entry > &entries() {
+		static std::vector< Entry > e;
+		return e;
+	}
+
+	uint64_t frames = 0; //frames ended so far
+}
+
+StatCounter::StatCounter(char const *name_) : name(name_) {
+	entries().emplace_back();
+	entries().back().counter = this;
+}
+
+void stats_end_frame() {
+	for (Entry &e : entries()) {
+		e.history[frames % StatsWindow] = e.counter->value;
+		e.counter->value = 0.0;
+	}
+	frames += 1;
+}
+
+uint32_t stats_count() {
+	return uint32_t(entries().size());
+}
+
+StatCounter const &stats_counter(uint32_t index) {
+	return *entries()[index].counter;
+}
+
+StatSummary stats_summary(uint32_t index) {
+	StatSummary s;
+	uint32_t n = uint32_t(std::min< uint64_t >(frames, StatsWindow));
+	if (n == 0) return s;
+	Entry const &e = entries()[index];
+	s.last = e.history[(frames - 1) % StatsWindow];
+
+	double sorted[StatsWindow];
+	std::copy(e.history, e.history + n, sorted); //(before the ring fills, its first n slots are the valid ones)
+	double sum = 0.0;
+	for (uint32_t i = 0; i < n; ++i) sum += sorted[i];
+	s.avg = sum / n;
+	s.min = *std::min_element(sorted, sorted + n);
+	//nearest-rank 99th percentile:
+	uint32_t rank = std::min(n - 1, (99 * n + 99) / 100 - 1);
+	std::nth_element(sorted, sorted + rank, sorted + n);
+	s.p99 = sorted[rank];
+	return s;
+}
+
+void stats_write_csv_header(std::ostream &out) {
+	out << "frame";
+	for (Entry const &e : entries()) {
+		for (char const *field : { "last", "min", "avg", "p99" }) {
+			out << ",\"" << e.counter->name << ' ' << field << '"';
+		}
+	}
+	out << '\n';
+}
+
+void stats_write_csv(std::ostream &out, uint64_t frame) {
+	out << frame;
+	for (uint32_t i = 0; i < stats_count(); ++i) {
+		StatSummary s = stats_summary(i);
+		out << ',' << s.last << ',' << s.min << ',' << s.avg << ',' << s.p99;
+	}
+	out << '\n';
+}
+
+void stats_write_json(std::ostream &out, uint64_t frame) {
+	out << "{\"frame\":" << frame;
+	for (uint32_t i = 0; i < stats_count(); ++i) {
+		StatSummary s = stats_summary(i);
+		out << ",\"" << stats_counter(i).name << "\":{\"last\":" << s.last << ",\"min\":" << s.min
+		    << ",\"avg\":" << s.avg << ",\"p99\":" << s.p99 << '}';
+	}
+	out << "}\n";
+}
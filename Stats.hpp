@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+//Named per-frame counters with rolling statistics:
+// code with something to count keeps a StatCounter (at namespace scope, so every counter is
+// registered before main() runs) and adds to it or sets it. Once per frame, stats_end_frame()
+// pushes each counter's value into a window of the last StatsWindow frames and resets it to zero.
+// Counters are for the main thread only.
+struct StatCounter {
+	explicit StatCounter(char const *name); //'name' must outlive the counter (e.g., a string literal)
+	StatCounter(StatCounter const &) = delete;
+	StatCounter &operator=(StatCounter const &) = delete;
+
+	StatCounter &operator+=(double amount) { value += amount; return *this; }
+	void set(double value_) { value = value_; }
+
+	char const *name;
+	double value = 0.0; //total for the current frame so far
+};
+
+constexpr uint32_t StatsWindow = 120; //frames summarized by stats_summary()
+
+struct StatSummary {
+	double last = 0.0; //most recent frame
+	double min = 0.0, avg = 0.0, p99 = 0.0; //over the window
+};
+
+void stats_end_frame();
+
+//registered counters, in registration order:
+uint32_t stats_count();
+StatCounter const &stats_counter(uint32_t index);
+StatSummary stats_summary(uint32_t index);
+
+//periodic output: one line per call, as CSV (frame, then each counter's last,min,avg,p99) or
+// as a JSON object per line; the CSV header names the columns:
+void stats_write_csv_header(std::ostream &out);
+void stats_write_csv(std::ostream &out, uint64_t frame);
+void stats_write_json(std::ostream &out, uint64_t frame);
@@ -0,0 +1,105 @@
+#include "StatsOverlay.hpp"
+
+#include "Stats.hpp"
+
+#include <cstdio>
+#include <iostream>
+
+namespace {
+	//row swatch colors (cycled):
+	const glm::u8vec4 swatch_colors[] = {
+		glm::u8vec4(0xe6, 0x19, 0x4b, 0xff),
+		glm::u8vec4(0x3c, 0xb4, 0x4b, 0xff),
+		glm::u8vec4(0xff, 0xe1, 0x19, 0xff),
+		glm::u8vec4(0x43, 0x63, 0xd8, 0xff),
+		glm::u8vec4(0xf5, 0x82, 0x31, 0xff),
+		glm::u8vec4(0x91, 0x1e, 0xb4, 0xff),
+		glm::u8vec4(0x42, 0xd4, 0xf4, 0xff),
+		glm::u8vec4(0xf0, 0x32, 0xe6, 0xff),
+	};
+	constexpr uint32_t swatch_colors_size = uint32_t(sizeof(swatch_colors) / sizeof(swatch_colors[0]));
+
+	const glm::u8vec4 panel_color = glm::u8vec4(0x00, 0x00, 0x00, 0xa0);
+	const glm::u8vec4 digit_color = glm::u8vec4(0xff, 0xff, 0xff, 0xff);
+
+	constexpr uint32_t column_chars = 8; //characters per number column
+
+	//segments, as bits:  a (top) = 0, b (top right), c (bottom right), d (bottom), e (bottom left), f (top left), g (middle):
+	uint8_t segments(char c) {
+		switch (c) {
+			case '0': return 0x3f;
+			case '1': return 0x06;
+			case '2': return 0x5b;
+			case '3': return 0x4f;
+			case '4': return 0x66;
+			case '5': return 0x6d;
+			case '6': return 0x7d;
+			case '7': return 0x07;
+			case '8': return 0x7f;
+			case '9': return 0x6f;
+			case '-': return 0x40;
+			default: return 0x00;
+		}
+	}
+}
+
+void draw_stats_overlay(Renderer2D &renderer, uint16_t layer, glm::vec2 const &top_left, float row_height) {
+	//everything uses one (blended) key, so it draws in submission order -- panel first:
+	Renderer2D::Key key(layer, Renderer2D::Alpha);
+
+	float h = 0.7f * row_height; //digit height
+	float w = 0.5f * h; //digit width
+	float t = 0.12f * h; //segment thickness
+	float advance = w + 2.0f * t; //per character
+
+	//seven-segment text with its bottom-left corner at 'at':
+	auto draw_text = [&](glm::vec2 at, char const *text) {
+		for (char const *c = text; *c; ++c) {
+			if (*c == '.') {
+				renderer.rect(key, at + glm::vec2(0.5f * t, 0.5f * t), glm::vec2(0.5f * t), digit_color);
+				at.x += 2.0f * t;
+				continue;
+			}
+			uint8_t bits = segments(*c);
+			glm::vec2 horizontal = glm::vec2(0.5f * w, 0.5f * t);
+			glm::vec2 vertical = glm::vec2(0.5f * t, 0.25f * h);
+			if (bits & 0x01) renderer.rect(key, at + glm::vec2(0.5f * w, h - 0.5f * t), horizontal, digit_color);
+			if (bits & 0x02) renderer.rect(key, at + glm::vec2(w - 0.5f * t, 0.75f * h), vertical, digit_color);
+			if (bits & 0x04) renderer.rect(key, at + glm::vec2(w - 0.5f * t, 0.25f * h), vertical, digit_color);
+			if (bits & 0x08) renderer.rect(key, at + glm::vec2(0.5f * w, 0.5f * t), horizontal, digit_color);
+			if (bits & 0x10) renderer.rect(key, at + glm::vec2(0.5f * t, 0.25f * h), vertical, digit_color);
+			if (bits & 0x20) renderer.rect(key, at + glm::vec2(0.5f * t, 0.75f * h), vertical, digit_color);
+			if (bits & 0x40) renderer.rect(key, at + glm::vec2(0.5f * w, 0.5f * h), horizontal, digit_color);
+			at.x += advance;
+		}
+	};
+
+	uint32_t rows = stats_count();
+	float swatch = row_height; //swatch column width
+	glm::vec2 size = glm::vec2(swatch + 3.0f * column_chars * advance, rows * row_height);
+	renderer.rect(key, top_left + glm::vec2(0.5f * size.x, -0.5f * size.y), 0.5f * size, panel_color);
+
+	for (uint32_t i = 0; i < rows; ++i) {
+		glm::vec2 row = top_left + glm::vec2(0.0f, -(i + 1.0f) * row_height);
+		float pad = 0.5f * (row_height - h);
+		renderer.rect(key, row + glm::vec2(0.5f * swatch, 0.5f * row_height), glm::vec2(0.5f * h), swatch_colors[i % swatch_colors_size]);
+
+		StatSummary s = stats_summary(i);
+		double values[3] = { s.min, s.avg, s.p99 };
+		for (uint32_t v = 0; v < 3; ++v) {
+			//one decimal for small values, none for large ones, to fit the column:
+			char text[32];
+			std::snprintf(text, sizeof(text), (values[v] < 1000.0 && values[v] > -100.0) ? "%.1f" : "%.0f", values[v]);
+			draw_text(row + glm::vec2(swatch + v * column_chars * advance, pad), text);
+		}
+	}
+}
+
+void print_stats_overlay_legend() {
+	std::cout << "Stats overlay (min, avg, p99 over the last " << StatsWindow << " frames):\n";
+	char const *color_names[swatch_colors_size] = { "red", "green", "yellow", "blue", "orange", "purple", "cyan", "magenta" };
+	for (uint32_t i = 0; i < stats_count(); ++i) {
+		std::cout << "  row " << (i + 1) << " (" << color_names[i % swatch_colors_size] << "): " << stats_counter(i).name << '\n';
+	}
+	std::cout.flush();
+}
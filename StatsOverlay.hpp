@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Renderer2D.hpp"
+
+//Draws the rolling stats (see Stats.hpp) as rectangles: one row per counter, each a colored
+// swatch followed by min, avg and p99 in seven-segment digits. Rows are in stats_counter() order
+// (print_stats_overlay_legend() lists them with their names).
+// 'top_left' and 'row_height' are in the renderer's world units; everything goes in 'layer'.
+void draw_stats_overlay(Renderer2D &renderer, uint16_t layer, glm::vec2 const &top_left, float row_height);
+
+//print which counter each row shows (and its swatch color) to std::cout:
+void print_stats_overlay_legend();
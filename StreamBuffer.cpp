@@ -0,0 +1,73 @@
+#include "StreamBuffer.hpp"
+
+#include "gl_errors.hpp"
+#include "gl_call_count.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+StreamBuffer::StreamBuffer(uint32_t segments_) : segments(segments_), fences(segments_, GLsync(0)) {
+	assert(segments > 0);
+	glGenBuffers(1, &buffer);
+	GL_ERRORS();
+}
+
+StreamBuffer::~StreamBuffer() {
+	for (auto &f : fences) {
+		if (f) glDeleteSync(f);
+		f = 0;
+	}
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+void *StreamBuffer::map(GLsizeiptr bytes, GLintptr *offset) {
+	assert(bytes > 0);
+	assert(offset);
+
+	GL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+
+	if (bytes > segment_size) {
+		//grow to the next power of two; glBufferData orphans the old storage,
+		// so the GPU can finish with it while we write to the new one:
+		GLsizeiptr size = 4096;
+		while (size < bytes) size *= 2;
+		segment_size = size;
+		GL_COUNTED(glBufferData(GL_ARRAY_BUFFER, segment_size * segments, nullptr, GL_STREAM_DRAW));
+		for (auto &f : fences) {
+			if (f) {
+				GL_COUNTED(glDeleteSync(f));
+			}
+			f = 0;
+		}
+	}
+
+	//wait until the GPU is done reading this region from 'segments' frames ago:
+	if (fences[current]) {
+		GLenum status;
+		do {
+			status = GL_COUNTED(glClientWaitSync(fences[current], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000)); //1s, in nanoseconds
+		} while (status == GL_TIMEOUT_EXPIRED);
+		if (status == GL_WAIT_FAILED) throw std::runtime_error("glClientWaitSync failed on a stream buffer fence.");
+		GL_COUNTED(glDeleteSync(fences[current]));
+		fences[current] = 0;
+	}
+
+	*offset = GLintptr(current) * segment_size;
+	void *data = GL_COUNTED(glMapBufferRange(GL_ARRAY_BUFFER, *offset, bytes,
+		GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT));
+	if (!data) throw std::runtime_error("glMapBufferRange failed on a stream buffer.");
+	return data;
+}
+
+void StreamBuffer::unmap(GLsizeiptr written) {
+	GL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+	if (written > 0) GL_COUNTED(glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, written));
+	GL_COUNTED(glUnmapBuffer(GL_ARRAY_BUFFER));
+}
+
+void StreamBuffer::fence() {
+	assert(!fences[current]);
+	fences[current] = GL_COUNTED(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	current = (current + 1) % segments;
+}
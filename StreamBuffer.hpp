@@ -0,0 +1,34 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <cstdint>
+#include <vector>
+
+//Ring-buffered streaming vertex buffer:
+// the buffer is split into 'segments' equal regions, and each frame writes the
+// next region directly through an unsynchronized mapping (no driver copy, no
+// implicit sync). A fence placed after the frame's draws guards each region;
+// map() only waits if the GPU is still reading the region from 'segments' frames ago.
+//
+// Per frame:  p = map(bytes, &offset); write to p; unmap(written); draw from 'buffer' at offset; fence();
+struct StreamBuffer {
+	explicit StreamBuffer(uint32_t segments = 3);
+	~StreamBuffer();
+
+	GLuint buffer = 0;
+
+	//map 'bytes' (> 0) of write-only memory in the next region, growing the buffer if needed.
+	// *offset receives the byte offset of the region within 'buffer'. Leaves 'buffer' bound to GL_ARRAY_BUFFER.
+	void *map(GLsizeiptr bytes, GLintptr *offset);
+	//finish writing; only the first 'written' bytes of the mapping are flushed to the GPU:
+	void unmap(GLsizeiptr written);
+	//call after issuing the draws that read the region; moves on to the next region:
+	void fence();
+
+	uint32_t segments;
+	GLsizeiptr segment_size = 0; //bytes per region
+	uint32_t current = 0; //region used by the current frame
+	std::vector< GLsync > fences; //per region; 0 if not in use by the GPU
+
+};
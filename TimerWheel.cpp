@@ -0,0 +1,71 @@
+#include "TimerWheel.hpp"
+
+void TimerWheel::schedule(uint64_t deadline, uint32_t event, uint32_t data) {
+	Timer t;
+	t.deadline = (deadline > now ? deadline : now + 1);
+	t.event = event;
+	t.data = data;
+	place(t);
+	pending += 1;
+}
+
+void TimerWheel::place(Timer const &t) {
+	uint64_t delta = t.deadline - now;
+	for (uint32_t level = 0; level < Levels; ++level) {
+		if (delta < (uint64_t(1) << (SlotBits * (level + 1)))) {
+			slots[level][(t.deadline >> (SlotBits * level)) & (Slots - 1)].emplace_back(t);
+			return;
+		}
+	}
+	overflow.emplace_back(t);
+}
+
+void TimerWheel::cascade() {
+	//find the coarsest level whose slot boundary 'now' sits on:
+	uint32_t top = 0;
+	while (top + 1 < Levels && (now & ((uint64_t(1) << (SlotBits * (top + 1))) - 1)) == 0) {
+		top += 1;
+	}
+	if (top + 1 == Levels && (now & ((uint64_t(1) << (SlotBits * Levels)) - 1)) == 0) {
+		//the whole wheel has turned over; far-future timers may now fit:
+		std::vector< Timer > later;
+		later.swap(overflow);
+		for (Timer const &t : later) place(t);
+	}
+	//redistribute coarse-to-fine so timers can fall more than one level:
+	for (uint32_t level = top; level > 0; --level) {
+		std::vector< Timer > &slot = slots[level][(now >> (SlotBits * level)) & (Slots - 1)];
+		if (slot.empty()) continue;
+		firing.swap(slot);
+		for (Timer const &t : firing) place(t);
+		firing.clear();
+	}
+}
+
+bool TimerWheel::placed_correctly() const {
+	for (uint32_t level = 0; level < Levels; ++level) {
+		uint32_t shift = SlotBits * level;
+		for (uint32_t s = 0; s < Slots; ++s) {
+			for (Timer const &t : slots[level][s]) {
+				//the slot must be the one the deadline maps to, and it must come up (again) within one rotation:
+				if (t.deadline <= now || ((t.deadline >> shift) & (Slots - 1)) != s) return false;
+				uint64_t ahead = (t.deadline >> shift) - (now >> shift);
+				if (ahead < 1 || ahead > Slots) return false;
+			}
+		}
+	}
+	for (Timer const &t : overflow) {
+		if ((t.deadline >> (SlotBits * Levels)) <= (now >> (SlotBits * Levels))) return false;
+	}
+	return true;
+}
+
+void TimerWheel::clear() {
+	for (auto &level : slots) {
+		for (auto &slot : level) {
+			slot.clear();
+		}
+	}
+	overflow.clear();
+	pending = 0;
+}
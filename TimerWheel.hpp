@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+//Hierarchical timer wheel: schedules events at integer tick deadlines.
+// Scheduling is O(1); timers sit untouched in coarse slots until their slot
+// comes due, then cascade into finer levels and finally fire in deadline order.
+// Timers carry plain data (an event code and a payload) rather than closures,
+// so pending timers can be copied or saved as-is.
+struct TimerWheel {
+	struct Timer {
+		uint64_t deadline; //tick at which the timer fires
+		uint32_t event; //what to do (meaning defined by the owner)
+		uint32_t data; //which entity, etc.
+	};
+
+	static constexpr uint32_t SlotBits = 6;
+	static constexpr uint32_t Slots = 1 << SlotBits; //slots per level
+	static constexpr uint32_t Levels = 4; //covers 2^24 ticks; anything later waits in 'overflow'
+
+	uint64_t now = 0; //last tick processed by advance()
+
+	//schedule an event; deadlines at or before 'now' fire on the next tick:
+	void schedule(uint64_t deadline, uint32_t event, uint32_t data = 0);
+
+	//process ticks (now, to], calling fire(Timer const &) for each timer in deadline order.
+	// fire may schedule more timers (including ones due within this same advance).
+	template< typename F >
+	void advance(uint64_t to, F &&fire) {
+		while (now < to) {
+			now += 1;
+			cascade();
+			std::vector< Timer > &slot = slots[0][now & (Slots - 1)];
+			if (slot.empty()) continue;
+			//swap out so fire() can safely schedule into this slot:
+			firing.swap(slot);
+			for (Timer const &t : firing) {
+				pending -= 1;
+				fire(t);
+			}
+			firing.clear();
+		}
+	}
+
+	//number of scheduled timers:
+	uint32_t pending = 0;
+
+	//visit every pending timer (in no particular order):
+	template< typename F >
+	void for_each(F &&f) const {
+		for (auto const &level : slots) {
+			for (auto const &slot : level) {
+				for (Timer const &t : slot) f(t);
+			}
+		}
+		for (Timer const &t : overflow) f(t);
+	}
+
+	void clear();
+
+	//true if every timer sits where advance() will reach it no later than its deadline
+	// (level-L timers in slot (deadline >> L*SlotBits) of the next rotation; overflow past this one);
+	// for checking wheels that were filled directly, e.g. from a saved copy:
+	bool placed_correctly() const;
+
+	std::vector< Timer > slots[Levels][Slots];
+	std::vector< Timer > overflow;
+	std::vector< Timer > firing; //scratch
+
+	//place a timer relative to 'now':
+	void place(Timer const &t);
+	//move timers from coarser levels whose slot starts at 'now':
+	void cascade();
+};
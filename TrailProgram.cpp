@@ -0,0 +1,81 @@
+#include "TrailProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+TrailProgram::TrailProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"uniform samplerBuffer POINTS;\n"
+		"uniform int FIRST_POINT;\n"
+		"uniform int POINT_COUNT;\n"
+		"uniform sampler1D COLORS;\n"
+		"uniform int STEPS;\n"
+		"uniform float TRAIL_LENGTH;\n"
+		"uniform vec2 RADIUS;\n"
+		"out vec4 color;\n"
+		"void main() {\n"
+		//draw from oldest to newest, i.e. steps [STEPS, ..., 1]:
+		"	int s = STEPS - gl_InstanceID;\n"
+		"	float t = float(s) / float(STEPS) * TRAIL_LENGTH;\n"
+		//first point after the oldest that is at most t old (ages decrease along the trail):
+		"	int lo = 1;\n"
+		"	int hi = POINT_COUNT;\n"
+		"	while (lo < hi) {\n"
+		"		int mid = (lo + hi) / 2;\n"
+		"		if (texelFetch(POINTS, FIRST_POINT + mid).z > t) lo = mid + 1;\n"
+		"		else hi = mid;\n"
+		"	}\n"
+		//if we ran out of recorded trail, draw nothing (degenerate strip):
+		"	if (lo >= POINT_COUNT) {\n"
+		"		gl_Position = vec4(0.0, 0.0, 0.0, 1.0);\n"
+		"		color = vec4(0.0);\n"
+		"		return;\n"
+		"	}\n"
+		//interpolate between previous and current trail point to the correct time:
+		"	vec4 a = texelFetch(POINTS, FIRST_POINT + lo - 1);\n"
+		"	vec4 b = texelFetch(POINTS, FIRST_POINT + lo);\n"
+		"	vec2 at = mix(a.xy, b.xy, (t - a.z) / (b.z - a.z));\n"
+		//strip corners 0..3 are (-,-), (+,-), (-,+), (+,+):
+		"	vec2 corner = vec2((gl_VertexID & 1) != 0 ? 1.0 : -1.0, (gl_VertexID & 2) != 0 ? 1.0 : -1.0);\n"
+		"	gl_Position = OBJECT_TO_CLIP * vec4(at + corner * RADIUS, 0.0, 1.0);\n"
+		//look up color along the gradient, where color k sits at (continuous) index k:
+		"	float size = float(textureSize(COLORS, 0));\n"
+		"	float c = float(s - 1) / float(STEPS - 1) * size;\n"
+		"	color = textureLod(COLORS, (c + 0.5) / size, 0.0);\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"in vec4 color;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		"	fragColor = color;\n"
+		"}\n"
+	);
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+	FIRST_POINT_int = glGetUniformLocation(program, "FIRST_POINT");
+	POINT_COUNT_int = glGetUniformLocation(program, "POINT_COUNT");
+	STEPS_int = glGetUniformLocation(program, "STEPS");
+	TRAIL_LENGTH_float = glGetUniformLocation(program, "TRAIL_LENGTH");
+	RADIUS_vec2 = glGetUniformLocation(program, "RADIUS");
+	GLuint POINTS_samplerBuffer = glGetUniformLocation(program, "POINTS");
+	GLuint COLORS_sampler1D = glGetUniformLocation(program, "COLORS");
+
+	//set the samplers to always refer to texture bindings zero and one:
+	glUseProgram(program);
+
+	glUniform1i(POINTS_samplerBuffer, 0); //POINTS samples from GL_TEXTURE0
+	glUniform1i(COLORS_sampler1D, 1); //COLORS samples from GL_TEXTURE1
+
+	glUseProgram(0);
+}
+
+TrailProgram::~TrailProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "GL.hpp"
+
+//Shader program that draws the bullet's trail from its raw control points:
+// POINTS holds (x, y, age, unused) per point, oldest first (ages decreasing), starting at texel
+// FIRST_POINT (so the points can live anywhere in a larger streamed buffer); instance i
+// draws the rectangle for step STEPS-i, i.e. the trail position TRAIL_LENGTH*(STEPS-i)/STEPS
+// seconds ago, found by binary search and linear interpolation, colored from the COLORS gradient.
+// It has no vertex attributes, so draw with glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, STEPS)
+// with any (e.g., empty) vertex array object bound.
+struct TrailProgram {
+	TrailProgram();
+	~TrailProgram();
+
+	GLuint program = 0;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+	GLuint FIRST_POINT_int = -1U;
+	GLuint POINT_COUNT_int = -1U;
+	GLuint STEPS_int = -1U;
+	GLuint TRAIL_LENGTH_float = -1U;
+	GLuint RADIUS_vec2 = -1U;
+
+	//Textures:
+	//TEXTURE0 - buffer texture (GL_RGBA32F) of trail points
+	//TEXTURE1 - 1D texture of trail colors, from oldest to newest
+};
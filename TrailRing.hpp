@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+//Fixed-capacity ring buffer of timestamped positions, oldest first.
+// Points keep the absolute time they were recorded, so nothing is aged per tick:
+// a point's age is (now - time), computed when it is read. Pushing and trimming
+// are O(1) and the storage is a single inline array. When full, pushing drops the oldest point.
+struct TrailRing {
+	struct Point {
+		glm::vec2 position;
+		double time; //simulation time at which the position was recorded
+	};
+	static_assert(sizeof(Point) == 16, "TrailRing::Point should be packed");
+
+	static constexpr uint32_t Capacity = 256; //must be a power of two
+
+	uint32_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	//i == 0 is the oldest point:
+	Point const &operator[](uint32_t i) const { return points[(head + i) & (Capacity - 1)]; }
+
+	void push(glm::vec2 const &position, double time) {
+		if (count == Capacity) pop_front();
+		Point &p = points[(head + count) & (Capacity - 1)];
+		p.position = position;
+		p.time = time;
+		count += 1;
+	}
+	void pop_front() {
+		head = (head + 1) & (Capacity - 1);
+		count -= 1;
+	}
+	void clear() {
+		head = 0;
+		count = 0;
+	}
+
+	//drop points older than 'length' seconds at time 'now'; since readers interpolate
+	// between points, the oldest point is only dropped once the one after it is too old:
+	void trim(double now, double length) {
+		while (count >= 2 && now - (*this)[1].time > length) pop_front();
+	}
+
+	Point points[Capacity];
+	uint32_t head = 0; //index of the oldest point
+	uint32_t count = 0;
+};
@@ -0,0 +1,77 @@
+#include "UniformGrid.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+UniformGrid::UniformGrid(glm::vec2 const &min_, glm::vec2 const &max_, float cell_size_) : min(min_), cell_size(cell_size_) {
+	assert(cell_size > 0.0f);
+	size = glm::ivec2(
+		std::max(1, int32_t(std::ceil((max_.x - min_.x) / cell_size))),
+		std::max(1, int32_t(std::ceil((max_.y - min_.y) / cell_size)))
+	);
+	cells.resize(size.x * size.y);
+}
+
+void UniformGrid::cell_range(glm::vec2 const &lo, glm::vec2 const &hi, glm::ivec2 *cmin, glm::ivec2 *cmax) const {
+	auto cell = [this](float v, float origin, int32_t count) {
+		int32_t c = int32_t(std::floor((v - origin) / cell_size));
+		return std::min(std::max(c, 0), count - 1);
+	};
+	*cmin = glm::ivec2(cell(lo.x, min.x, size.x), cell(lo.y, min.y, size.y));
+	*cmax = glm::ivec2(cell(hi.x, min.x, size.x), cell(hi.y, min.y, size.y));
+}
+
+void UniformGrid::insert(uint32_t id, glm::vec2 const &lo, glm::vec2 const &hi) {
+	glm::ivec2 cmin, cmax;
+	cell_range(lo, hi, &cmin, &cmax);
+	for (int32_t y = cmin.y; y <= cmax.y; ++y) {
+		for (int32_t x = cmin.x; x <= cmax.x; ++x) {
+			cells[y * size.x + x].emplace_back(id);
+		}
+	}
+	if (id >= stamps.size()) stamps.resize(id + 1, 0);
+}
+
+void UniformGrid::remove(uint32_t id, glm::vec2 const &lo, glm::vec2 const &hi) {
+	glm::ivec2 cmin, cmax;
+	cell_range(lo, hi, &cmin, &cmax);
+	for (int32_t y = cmin.y; y <= cmax.y; ++y) {
+		for (int32_t x = cmin.x; x <= cmax.x; ++x) {
+			std::vector< uint32_t > &cell = cells[y * size.x + x];
+			auto f = std::find(cell.begin(), cell.end(), id);
+			assert(f != cell.end());
+			//order within a cell doesn't matter, so swap-and-pop:
+			*f = cell.back();
+			cell.pop_back();
+		}
+	}
+}
+
+void UniformGrid::query(glm::vec2 const &lo, glm::vec2 const &hi, std::vector< uint32_t > *out) {
+	assert(out);
+	stamp += 1;
+	if (stamp == 0) {
+		//stamp counter wrapped; reset so stale stamps can't alias:
+		std::fill(stamps.begin(), stamps.end(), 0);
+		stamp = 1;
+	}
+
+	glm::ivec2 cmin, cmax;
+	cell_range(lo, hi, &cmin, &cmax);
+	for (int32_t y = cmin.y; y <= cmax.y; ++y) {
+		for (int32_t x = cmin.x; x <= cmax.x; ++x) {
+			for (uint32_t id : cells[y * size.x + x]) {
+				if (stamps[id] == stamp) continue;
+				stamps[id] = stamp;
+				out->emplace_back(id);
+			}
+		}
+	}
+}
+
+void UniformGrid::clear() {
+	for (auto &cell : cells) {
+		cell.clear();
+	}
+}
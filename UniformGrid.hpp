@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+//Uniform grid broadphase over a fixed rectangle of the plane.
+// Objects are registered by id with an axis-aligned box and listed in every
+// cell that box touches; boxes that leave the grid are clamped to the edge cells.
+// The grid does not remember boxes, so callers pass the old box to remove.
+struct UniformGrid {
+	UniformGrid(glm::vec2 const &min, glm::vec2 const &max, float cell_size);
+
+	void insert(uint32_t id, glm::vec2 const &lo, glm::vec2 const &hi);
+	void remove(uint32_t id, glm::vec2 const &lo, glm::vec2 const &hi);
+
+	//append the ids of all objects whose cells overlap [lo,hi] to 'out' (each id at most once):
+	void query(glm::vec2 const &lo, glm::vec2 const &hi, std::vector< uint32_t > *out);
+
+	void clear();
+
+	glm::vec2 min;
+	float cell_size;
+	glm::ivec2 size; //number of cells along each axis
+	std::vector< std::vector< uint32_t > > cells; //row-major, cells[y * size.x + x]
+
+	//per-id query stamps used to de-duplicate ids that span several cells:
+	std::vector< uint32_t > stamps;
+	uint32_t stamp = 0;
+
+	//inclusive cell range covered by a box:
+	void cell_range(glm::vec2 const &lo, glm::vec2 const &hi, glm::ivec2 *cmin, glm::ivec2 *cmax) const;
+};
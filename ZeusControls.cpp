@@ -0,0 +1,24 @@
+#include "ZeusControls.hpp"
+#include "ZeusView.hpp"
+
+#include <cassert>
+
+void ZeusControls::apply(InputEvent const &evt, ZeusSim *sim) {
+    assert(sim);
+    if (evt.type == InputEvent::Update) {
+        sim->update(evt.elapsed);
+    } else if (evt.type == InputEvent::Resize) {
+        window_size = glm::uvec2(evt.value);
+    } else if (evt.type == InputEvent::MouseMotion) {
+        if (window_size.x == 0 || window_size.y == 0) return;
+        ZeusView view(sim->scene_radius, window_size.x / float(window_size.y));
+        sim->move_cloud(view.window_to_court(evt.value, window_size).x);
+    } else if (evt.type == InputEvent::MouseUp) {
+        //fire bullet
+        sim->fire();
+    } else if (evt.type == InputEvent::QuickSave) {
+        sim->save(&quick_save);
+    } else if (evt.type == InputEvent::QuickLoad) {
+        if (!quick_save.empty()) sim->load(quick_save);
+    }
+}
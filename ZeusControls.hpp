@@ -0,0 +1,18 @@
+#pragma once
+
+#include "ZeusSim.hpp"
+#include "InputLog.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+//Applies player input (see InputEvent) to a ZeusSim.
+// ZeusMode feeds it events translated from SDL; zeus-headless feeds it a recorded log.
+struct ZeusControls {
+    //apply one event (Update events advance the sim by evt.elapsed):
+    void apply(InputEvent const &evt, ZeusSim *sim);
+    
+    glm::uvec2 window_size = glm::uvec2(0); //from the most recent Resize event
+    std::vector< uint8_t > quick_save; //written by QuickSave, restored by QuickLoad
+};
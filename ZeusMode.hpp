@@ -5,89 +5,84 @@
 //  Created by owen ou on 2021/9/4.
 //
 
-#include "ColorTextureProgram.hpp"
+#pragma once
+
+#include "Renderer2D.hpp"
+#include "StreamBuffer.hpp"
+#include "TrailProgram.hpp"
+#include "ZeusSim.hpp"
+#include "ZeusControls.hpp"
+#include "InputLog.hpp"
 
 #include "Mode.hpp"
 #include "GL.hpp"
 
 #include <glm/glm.hpp>
 
+#include <memory>
+#include <string>
 #include <vector>
-#include <deque>
 
 struct ZeusMode : Mode {
-    ZeusMode();
+    //see ZeusSim for the meaning of 'stress' and 'seed'.
+    //if record_filename is given, all input is logged there for replay by zeus-headless:
+    explicit ZeusMode(bool stress = false, uint64_t seed = 0, std::string const &record_filename = "");
     virtual ~ZeusMode();
     
     //functions called by main_loop
     virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) override;
     virtual void update(float elapsed) override;
-    virtual void draw(glm::uvec2 const &drawable_size) override;
+    virtual void draw(glm::uvec2 const &drawable_size, float alpha) override;
     
     //----- game state -----
-    //TODO: fill in game object states, size, scores
-    glm::vec2 scene_radius = glm::vec2(7.0f, 5.0f);             //size of the scene
-    glm::vec2 cloud_radius = glm::vec2(1.0f, 0.2f);             //size of Zeus' cloud
-    glm::vec2 bullet_radius = glm::vec2(0.2f, 0.2f);            //size of bullet
+    ZeusSim sim;
     
-    glm::vec2 cloud = glm::vec2(0.0f, scene_radius.y - 1.0f);   //position of cloud, center of rectangle
+    //mouse moves the cloud, clicking fires, F5 saves a snapshot of 'sim', F9 rewinds to it:
+    ZeusControls controls;
     
-    // TODO: need vector to store multiple bullets
-//    std::deque< glm::vec3 > bullets;                          //(x,y,age), bullet position 2d
-//    std::deque< glm::vec3 > bullet_velocity;                  //bullet velocity, static at beginning
-    glm::vec2 bullet = glm::vec2(0.0f, cloud.y);                //bullet position 2d //TODO: place at center of cloud
-//    glm::vec3 bullet = glm::vec3(0.0f, cloud.y, 0.0f);        //(x,y,age)   //TODO: include age
-    glm::vec2 bullet_velocity = glm::vec2(0.0f, 0.0f);          //bullet velocity, static at beginning
-    glm::vec2 gravity = glm::vec2(0.0f, -9.8f);                  //gravitational acceleration
-    float bullet_cd = 0.5f;                                     //bullet cool down  //TODO: may not need this
-    bool bullet_fired = false;                                  //bullet fire state
-    //TODO: may need to add bullet life
+    //F3 toggles the stats overlay (see Stats.hpp); not part of the input log:
+    bool show_stats = false;
     
-    uint32_t score = 0;
+    //log of every InputEvent given to 'controls' (if recording):
+    std::unique_ptr< InputLogWriter > recording;
+    void apply(InputEvent const &input); //record + apply to sim
     
-    std::vector< glm::vec2 > buildings;                          //buildings center
-    std::vector< glm::vec2 > buildings_radius;                   //size of each building
-    const float buildings_width = 1.0f;                     //fixed width of each building
-    const int max_buildings = 7;                            //max number of buildings
-    float grow_rate = 0.1f;                                 //building growing rate
-    float spawn_cd_min = 0.5f;                          //new building min spawn cool down
-    float spawn_cd_max = 2.0f;                          //new building max spawn cool down
-    float grow_cd = 1.0f;                               //building growing cool down
-    float grow_update = 0.0f;                           //update last grow time
+    //----- opengl assets / helpers ------
     
-    float ai_offset = 0.0f;
-    float ai_offset_update = 0.0f;
+    //draw() submits each frame's rectangles to 'renderer', in these layers (back to front):
+    enum : uint16_t {
+        ShadowLayer,
+        TrailLayer,
+        SolidLayer,
+        HudLayer,
+        OverlayLayer,
+    };
+    Renderer2D renderer;
     
-    //----- pretty gradient trails -----
-    float trail_length = 0.2f;              //original: 1.3f, make shorter
-    std::deque< glm::vec3 > bullet_trail;   //stores (x,y,age), oldest elements first
+    //a cached group of rectangles that draw() only rebuilds when what it shows changes:
+    struct Layer {
+        Renderer2D::Batch batch; //shadow rectangles first, then solid ones
+        uint32_t shadows = 0; //number of shadow rectangles at the start of 'batch.rects'
+        uint64_t key = 0; //summary of the state 'batch' was built from
+        bool valid = false; //'batch' has been built at least once
+    };
+    Layer static_layer; //walls
+    Layer buildings_layer; //buildings + skyline
+    Layer hud_layer; //score
     
-    //----- opengl assets / helpers ------
+    //Shader program that draws the bullet's trail from its control points (so CPU cost doesn't depend on trail_steps):
+    TrailProgram trail_program;
     
-    //draw functions will work on vectors of vertices, defined as follows:
-    struct Vertex {
-        Vertex(glm::vec3 const &Position_, glm::u8vec4 const &Color_, glm::vec2 const &TexCoord_) :
-            Position(Position_), Color(Color_), TexCoord(TexCoord_) { }
-        glm::vec3 Position;
-        glm::u8vec4 Color;
-        glm::vec2 TexCoord;
-    };
-    static_assert(sizeof(Vertex) == 4*3 + 1*4 + 4*2, "Zeus::Vertex should be packed");
+    //trail control points as (x, y, age, 0), oldest first, written each frame into a region of trail_stream
+    // and read by trail_program through the buffer texture trail_points_texture:
+    StreamBuffer trail_stream;
+    GLuint trail_points_texture = 0;
+    GLint trail_first_point = 0; //index (in points) of this frame's region within trail_stream
+    GLint trail_point_count = 0;
     
-    //Shader program that draws transformed, vertices tinted with vertex colors:
-    ColorTextureProgram color_texture_program;
-
-    //Buffer used to hold vertex data during drawing:
-    GLuint vertex_buffer = 0;
-
-    //Vertex Array Object that maps buffer locations to color_texture_program attribute locations:
-    GLuint vertex_buffer_for_color_texture_program = 0;
-
-    //Solid white texture:
-    GLuint white_tex = 0;
-
-    //matrix that maps from clip coordinates to court-space coordinates:
-    glm::mat3x2 clip_to_court = glm::mat3x2(1.0f);
-    // computed in draw() as the inverse of OBJECT_TO_CLIP
-    // (stored here so that the mouse handling code can use it to position the paddle)
+    //1D texture of trail colors, oldest to newest (linearly filtered to make the gradient):
+    GLuint trail_colors_texture = 0;
+    
+    //Vertex Array Object with no attributes (trail_program builds vertices from gl_VertexID and gl_InstanceID):
+    GLuint empty_vertex_array = 0;
 };
@@ -0,0 +1,594 @@
+#include "ZeusSim.hpp"
+
+#include "ballistic.hpp"
+#include "Profiler.hpp"
+#include "Stats.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <assert.h> //prevent error
+
+static StatCounter collisions_tested("collisions tested");
+static StatCounter buildings_alive("buildings alive");
+static StatCounter bullets_live("bullets live");
+
+ZeusSim::ZeusSim(bool stress_, uint64_t seed) : stress(stress_),
+    scene_radius(stress_ ? glm::vec2(stress_columns * buildings_width, 5.0f) : glm::vec2(7.0f, 5.0f)),
+    rng(seed) {
+    stress_fire_random.resize(2 * stress_fire_batch);
+    bullets_landed.reserve(max_bullets);
+    
+    //set up trail as if bullet has been here for 'forever':
+    bullet_trail.clear();
+    bullet_trail.push(bullet, time - trail_length);
+    bullet_trail.push(bullet, time);
+    
+    //first building goes up right away, growth starts after one cool down:
+    timers.schedule(0, SpawnBuildings);
+    timers.schedule(timer_ticks(grow_cd), GrowBuildings);
+}
+
+uint64_t ZeusSim::timer_ticks(float seconds) const {
+    return timers.now + uint64_t(std::max(0.0f, seconds) * timer_rate + 0.5f);
+}
+
+void ZeusSim::on_timer(TimerWheel::Timer const &timer) {
+    if(timer.event == SpawnBuildings){
+        if(stress){
+            //build on a batch of random lots (taken lots are skipped):
+            for(uint32_t n = 0; n < stress_spawn_batch; n++){
+                skyline.spawn(rng.next_u32(skyline.columns));
+            }
+        }else if(buildings.size() < size_t(max_buildings)){
+            ai_offset = rng.next_float(-1.0f, 1.0f) * (scene_radius.x + buildings_width) * 0.5f;
+            
+            //bound buildings in the scene
+            buildings.push_back(Building{ ai_offset, grow_epoch });
+            glm::vec2 lo, hi;
+            building_footprint(buildings.back(), &lo, &hi);
+            buildings_grid.insert(uint32_t(buildings.size() - 1), lo, hi);
+        }else{
+            //city is full; build again as soon as something is destroyed:
+            spawn_waiting = true;
+            return;
+        }
+        city_version += 1;
+        //spawn again in [min,max) seconds:
+        timers.schedule(timer_ticks(rng.next_float() * (spawn_cd_max + spawn_cd_min)), SpawnBuildings);
+    }else if(timer.event == GrowBuildings){
+        //buildings derive their height from grow_epoch, so growing them all is a single increment:
+        grow_epoch += 1;
+        skyline.grow(1);
+        city_version += 1;
+        timers.schedule(timer_ticks(grow_cd), GrowBuildings);
+    }else if(timer.event == ReloadBullet){
+        bullet_loaded = true;
+    }
+}
+
+void ZeusSim::move_cloud(float x) {
+    cloud.x = x;
+    
+    //loaded bullet moves with cloud
+    bullet.x = cloud.x;
+}
+
+void ZeusSim::fire() {
+    bullet_fired = true;
+}
+
+void ZeusSim::update(float elapsed){
+    PROFILE_ZONE("ZeusSim::update");
+    
+    time += elapsed;
+    
+    //----- timed events (building spawn, growth, reload) -----
+    ProfileZone phase("timers");
+    timers.advance(uint64_t(time * timer_rate), [this](TimerWheel::Timer const &timer){
+        on_timer(timer);
+    });
+    
+    //clamp cloud to scene:
+    cloud.x = std::max(cloud.x, -scene_radius.x + cloud_radius.x);
+    cloud.x = std::min(cloud.x,  scene_radius.x - cloud_radius.x);
+    
+    
+    //----- bullet update -----
+    phase.next("fire + integrate");
+    //loaded bullet sits on the cloud:
+    bullet = cloud;
+    
+    if(bullet_fired){
+        bullet_fired = false;
+        if(bullet_loaded){
+            uint32_t b = bullets.spawn(bullet, glm::vec2(0.0f, 0.0f));
+            if(b != BulletPool::Invalid){
+                trail_bullet = b;
+                bullet_loaded = false;
+                timers.schedule(timer_ticks(bullet_cd), ReloadBullet);
+            }
+        }
+    }
+    
+    if(stress){
+        //rain bullets along the whole city (positions and velocities drawn as one batch):
+        float *x = stress_fire_random.data();
+        float *vx = x + stress_fire_batch;
+        rng.fill_floats(x, stress_fire_batch, -(scene_radius.x - bullet_radius.x), scene_radius.x - bullet_radius.x);
+        rng.fill_floats(vx, stress_fire_batch, -2.0f, 2.0f);
+        for(uint32_t n = 0; n < stress_fire_batch; n++){
+            if(bullets.spawn(glm::vec2(x[n], cloud.y), glm::vec2(vx[n], 0.0f)) == BulletPool::Invalid) break;
+        }
+    }
+    
+    //gravitational acceleration (displacement formula, vectorized over the pool):
+    bullets.integrate(elapsed, gravity);
+    
+    
+    //---- collision handling ----
+    
+    //bounce a bullet off a building box along 'axis' (0: bounce in x, 1: bounce in y):
+    auto respond = [&](glm::vec2 &pos, glm::vec2 &vel, glm::vec2 const &center, glm::vec2 const &radius, int axis) {
+        if (axis == 1) {
+            if (pos.y > center.y) {
+                pos.y = center.y + radius.y + bullet_radius.y;
+                vel.y = std::abs(vel.y) * 0.5f;         //velocity drop in half
+            } else {
+                pos.y = center.y - radius.y - bullet_radius.y;
+                vel.y = -std::abs(vel.y) * 0.5f;        //velocity drop in half
+            }
+            
+            float rand_x = rng.next_float(-1.0f, 1.0f) * 0.5f;        //random x velocity
+            vel.x += rand_x;
+        }else{
+            if (pos.x > center.x) {
+                pos.x = center.x + radius.x + bullet_radius.x;
+                vel.x = std::abs(vel.x) * 0.5f;
+            } else {
+                pos.x = center.x - radius.x - bullet_radius.x;
+                vel.x = -std::abs(vel.x) * 0.5f;
+            }
+            //warp y velocity based on offset from building center:
+            float warp = (pos.y - center.y) / (radius.y + bullet_radius.y);
+            vel.y = glm::mix(vel.y, warp, 0.75f);
+        }
+    };
+    
+    //bounce a bullet that already overlaps a building box, along the axis of least overlap:
+    auto bounce = [&](glm::vec2 &pos, glm::vec2 &vel, glm::vec2 const &center, glm::vec2 const &radius) {
+        //compute area of overlap:
+        glm::vec2 min = glm::max(center - radius, pos - bullet_radius);
+        glm::vec2 max = glm::min(center + radius, pos + bullet_radius);
+        
+        //if no overlap, no collision:
+        if (min.x > max.x || min.y > max.y) return false;
+        
+        //wider overlap in x => bounce in y direction, and vice versa:
+        respond(pos, vel, center, radius, (max.x - min.x > max.y - min.y) ? 1 : 0);
+        return true;
+    };
+    
+    //skyline (stress mode): one height lookup per bullet, hit columns are knocked down immediately:
+    phase.next("collide skyline");
+    if(stress){
+        for(uint32_t b = 0; b < bullets.end && skyline.standing > 0; b++){
+            if(!bullets.alive[b]) continue;
+            glm::vec2 pos = bullets.position(b);
+            glm::vec2 vel = bullets.velocity(b);
+            
+            uint32_t c0, c1;
+            float tallest;
+            collisions_tested += 1;
+            if(!skyline.hit(pos - bullet_radius, pos + bullet_radius, &c0, &c1, &tallest)) continue;
+            
+            //treat the hit columns as one building:
+            glm::vec2 lo = glm::vec2(skyline.min_x + c0 * skyline.column_width, skyline.floor_y);
+            glm::vec2 hi = glm::vec2(skyline.min_x + (c1 + 1) * skyline.column_width, tallest);
+            if(!bounce(pos, vel, 0.5f * (lo + hi), 0.5f * (hi - lo))) continue;
+            skyline.clear(c0, c1);
+            city_version += 1;
+            
+            bullets.x[b] = pos.x;
+            bullets.y[b] = pos.y;
+            bullets.vx[b] = vel.x;
+            bullets.vy[b] = vel.y;
+        }
+    }
+    
+    //buildings, with continuous collision detection:
+    // each bullet's parabolic path over the step is swept against candidate buildings from the
+    // grid, the earliest hit is resolved, and the bullet continues from there for the rest of
+    // the step. Hit buildings leave the grid right away so no other bullet can hit them, and
+    // are compacted out afterwards.
+    phase.next("collide buildings");
+    buildings_destroyed.clear();
+    uint32_t tested = 0; //bullet-path vs. building candidate tests
+    for(uint32_t b = 0; b < bullets.end && buildings_destroyed.size() < buildings.size(); b++){
+        if(!bullets.alive[b]) continue;
+        
+        //reconstruct the state at the start of the step:
+        glm::vec2 p0 = glm::vec2(bullets.px[b], bullets.py[b]);
+        glm::vec2 v0 = bullets.velocity(b) - gravity * elapsed;
+        float remaining = elapsed;
+        
+        uint32_t hits = 0;
+        for(; hits < max_hits_per_step; hits++){
+            glm::vec2 lo, hi;
+            ballistic_bounds(p0, v0, gravity, remaining, &lo, &hi);
+            building_candidates.clear();
+            buildings_grid.query(lo - bullet_radius, hi + bullet_radius, &building_candidates);
+            tested += uint32_t(building_candidates.size());
+            
+            //find the earliest building the path enters:
+            uint32_t first = uint32_t(-1);
+            float first_toi = 0.0f;
+            int first_axis = -1;
+            for(uint32_t i : building_candidates){
+                float toi;
+                int axis;
+                glm::vec2 center = building_center(buildings[i]);
+                glm::vec2 reach = building_radius(buildings[i]) + bullet_radius;
+                if(!ballistic_toi(p0, v0, gravity, remaining, center - reach, center + reach, &toi, &axis)) continue;
+                if(first != uint32_t(-1) && toi >= first_toi) continue;
+                first = i;
+                first_toi = toi;
+                first_axis = axis;
+            }
+            if(first == uint32_t(-1)) break;
+            
+            //move to the moment of impact and bounce:
+            glm::vec2 pos = ballistic_position(p0, v0, gravity, first_toi);
+            glm::vec2 vel = v0 + gravity * first_toi;
+            glm::vec2 center = building_center(buildings[first]);
+            glm::vec2 radius = building_radius(buildings[first]);
+            if(first_axis < 0){
+                //started the step overlapping (e.g. a building grew into it):
+                bounce(pos, vel, center, radius);
+            }else{
+                respond(pos, vel, center, radius, first_axis);
+            }
+            
+            //destroy building
+            glm::vec2 cells_lo, cells_hi;
+            building_footprint(buildings[first], &cells_lo, &cells_hi);
+            buildings_grid.remove(first, cells_lo, cells_hi);
+            buildings_destroyed.emplace_back(first);
+            
+            p0 = pos;
+            v0 = vel;
+            remaining -= first_toi;
+        }
+        
+        //bullets that hit something finish the step along their new path:
+        if(hits > 0){
+            glm::vec2 pos = ballistic_position(p0, v0, gravity, remaining);
+            glm::vec2 vel = v0 + gravity * remaining;
+            bullets.x[b] = pos.x;
+            bullets.y[b] = pos.y;
+            bullets.vx[b] = vel.x;
+            bullets.vy[b] = vel.y;
+        }
+    }
+    
+    collisions_tested += tested;
+    
+    //erase destroyed buildings by swapping in the last building, highest index first so pending indices stay valid:
+    std::sort(buildings_destroyed.begin(), buildings_destroyed.end(), std::greater< uint32_t >());
+    for(uint32_t i : buildings_destroyed){
+        uint32_t last = uint32_t(buildings.size() - 1);
+        if(i != last){
+            glm::vec2 lo, hi;
+            building_footprint(buildings[last], &lo, &hi);
+            buildings_grid.remove(last, lo, hi);
+            buildings[i] = buildings[last];
+            buildings_grid.insert(i, lo, hi);
+        }
+        buildings.pop_back();
+    }
+    if(!buildings_destroyed.empty()) city_version += 1;
+    if(spawn_waiting && !buildings_destroyed.empty()){
+        spawn_waiting = false;
+        timers.schedule(timers.now, SpawnBuildings);
+    }
+    
+    
+    //scene walls (vectorized over the pool):
+    phase.next("collide walls");
+    bullets_landed.clear();
+    bullets.bounce_walls(-scene_radius + bullet_radius, scene_radius - bullet_radius, &bullets_landed);
+    for(uint32_t b : bullets_landed){
+        //bullet touched lower wall while falling, it's done:
+        if(b == trail_bullet) trail_bullet = BulletPool::Invalid;
+        bullets.kill(b);
+    }
+    
+    //----- gradient trails -----
+    phase.next("trail");
+    
+    //store fresh location at back of ball trail (follows the last shot, or the cloud once it lands):
+    bullet_trail.push(trail_bullet != BulletPool::Invalid ? bullets.position(trail_bullet) : bullet, time);
+
+    //trim any too-old locations from front of trail:
+    bullet_trail.trim(time, trail_length);
+    
+    buildings_alive.set(stress ? skyline.standing : buildings.size());
+    bullets_live.set(bullets.live);
+}
+
+//----- snapshots -----
+
+constexpr uint32_t ZeusSim::snapshot_version; //odr-used by Writer::value (needs a definition under C++14)
+
+namespace {
+    //blob layout: "ZSIM", version, total size, then fixed-size fields and length-prefixed arrays, in save() order.
+    const uint32_t snapshot_magic = 0x4d49535a; //'ZSIM' in little-endian
+    
+    struct Writer {
+        std::vector< uint8_t > &out;
+        void bytes(void const *data, size_t size) {
+            size_t at = out.size();
+            out.resize(at + size);
+            if (size) std::memcpy(out.data() + at, data, size);
+        }
+        template< typename T > void value(T const &v) {
+            bytes(&v, sizeof(T));
+        }
+        template< typename T > void array(T const *data, uint32_t count) {
+            value(count);
+            bytes(data, count * sizeof(T));
+        }
+    };
+    
+    struct Reader {
+        std::vector< uint8_t > const &in;
+        size_t at = 0;
+        void bytes(void *data, size_t size) {
+            if (size > in.size() - at) throw std::runtime_error("Snapshot is truncated.");
+            if (size) std::memcpy(data, in.data() + at, size);
+            at += size;
+        }
+        template< typename T > void value(T *v) {
+            bytes(v, sizeof(T));
+        }
+        //read a length-prefixed array into 'data', which must hold at least 'max' elements:
+        template< typename T > uint32_t array(T *data, uint32_t max) {
+            uint32_t count = 0;
+            value(&count);
+            if (count > max) throw std::runtime_error("Snapshot array is larger than this sim allows.");
+            bytes(data, count * sizeof(T));
+            return count;
+        }
+        //find a length-prefixed array of at most 'max' elements without copying it:
+        // returns its length, and *offset gets where its elements start in 'in'
+        template< typename T > uint32_t locate(size_t *offset, uint32_t max) {
+            uint32_t count = 0;
+            value(&count);
+            if (count > max) throw std::runtime_error("Snapshot array is larger than this sim allows.");
+            if (count > (in.size() - at) / sizeof(T)) throw std::runtime_error("Snapshot is truncated.");
+            *offset = at;
+            at += count * sizeof(T);
+            return count;
+        }
+        template< typename T > void array(std::vector< T > *data) {
+            uint32_t count = 0;
+            value(&count);
+            if (count > (in.size() - at) / sizeof(T)) throw std::runtime_error("Snapshot is truncated.");
+            data->resize(count);
+            bytes(data->data(), count * sizeof(T));
+        }
+    };
+}
+
+void ZeusSim::save(std::vector< uint8_t > *blob) const {
+    assert(blob);
+    blob->clear();
+    Writer w{*blob};
+    
+    w.value(snapshot_magic);
+    w.value(snapshot_version);
+    w.value(uint32_t(0)); //total size, patched below
+    w.value(uint8_t(stress));
+    
+    //player / cloud:
+    w.value(cloud);
+    w.value(bullet);
+    w.value(trail_bullet);
+    w.value(uint8_t(bullet_loaded));
+    w.value(uint8_t(bullet_fired));
+    w.value(score);
+    
+    //bullet pool (slots [0,end) only; the free list refers to nothing past 'end'):
+    w.value(bullets.live);
+    w.array(bullets.x.data(), bullets.end);
+    w.array(bullets.y.data(), bullets.end);
+    w.array(bullets.px.data(), bullets.end);
+    w.array(bullets.py.data(), bullets.end);
+    w.array(bullets.vx.data(), bullets.end);
+    w.array(bullets.vy.data(), bullets.end);
+    w.array(bullets.age.data(), bullets.end);
+    w.array(bullets.alive.data(), bullets.end);
+    w.array(bullets.free_list.data(), uint32_t(bullets.free_list.size()));
+    
+    //city (the broadphase grid is rebuilt from this on load):
+    w.array(buildings.data(), uint32_t(buildings.size()));
+    w.value(grow_epoch);
+    w.value(ai_offset);
+    w.value(uint8_t(spawn_waiting));
+    w.array(skyline.heights.data(), skyline.columns);
+    
+    //timers and random numbers:
+    w.value(time);
+    //wheel slots are saved verbatim (not re-scheduled) so same-tick timers keep their firing order:
+    w.value(timers.now);
+    for (auto const &level : timers.slots) {
+        for (auto const &slot : level) {
+            w.array(slot.data(), uint32_t(slot.size()));
+        }
+    }
+    w.array(timers.overflow.data(), uint32_t(timers.overflow.size()));
+    w.value(rng.seed);
+    w.value(rng.counter);
+    
+    //trail:
+    w.value(bullet_trail.size());
+    for (uint32_t i = 0; i < bullet_trail.size(); ++i) {
+        w.value(bullet_trail[i]);
+    }
+    
+    uint32_t size = uint32_t(blob->size());
+    std::memcpy(blob->data() + 2 * sizeof(uint32_t), &size, sizeof(size));
+}
+
+void ZeusSim::load(std::vector< uint8_t > const &blob) {
+    Reader r{blob};
+    
+    uint32_t magic = 0, version = 0, size = 0;
+    uint8_t flag = 0;
+    r.value(&magic);
+    r.value(&version);
+    r.value(&size);
+    if (magic != snapshot_magic) throw std::runtime_error("Not a ZeusSim snapshot.");
+    if (version != snapshot_version) throw std::runtime_error("Snapshot version " + std::to_string(version) + " is not supported (expecting " + std::to_string(snapshot_version) + ").");
+    if (size != blob.size()) throw std::runtime_error("Snapshot size does not match its header.");
+    r.value(&flag);
+    if (bool(flag) != stress) throw std::runtime_error("Snapshot was saved from a sim with a different stress setting.");
+    
+    //everything is decoded and checked into temporaries first, so a bad blob leaves this sim untouched:
+    glm::vec2 new_cloud, new_bullet;
+    uint32_t new_trail_bullet = 0, new_score = 0;
+    uint8_t new_bullet_loaded = 0, new_bullet_fired = 0;
+    r.value(&new_cloud);
+    r.value(&new_bullet);
+    r.value(&new_trail_bullet);
+    r.value(&new_bullet_loaded);
+    r.value(&new_bullet_fired);
+    r.value(&new_score);
+    
+    //the bullet arrays are checked where they lie in the blob; only slots [0,end) are copied, once the blob is accepted:
+    uint32_t new_live = 0;
+    r.value(&new_live);
+    size_t bullet_arrays[7]; //offsets of x, y, px, py, vx, vy, age in 'blob'
+    size_t alive_array = 0;
+    uint32_t new_end = r.locate< float >(&bullet_arrays[0], bullets.capacity);
+    for (uint32_t a = 1; a < 7; ++a) {
+        if (r.locate< float >(&bullet_arrays[a], bullets.capacity) != new_end) throw std::runtime_error("Snapshot bullet arrays disagree in length.");
+    }
+    if (r.locate< uint8_t >(&alive_array, bullets.capacity) != new_end) throw std::runtime_error("Snapshot bullet arrays disagree in length.");
+    uint8_t const *new_alive = blob.data() + alive_array;
+    std::vector< uint32_t > new_free_list;
+    r.array(&new_free_list);
+    {   //the free list must name each dead slot below 'end' exactly once, and 'live' must count the rest:
+        uint32_t alive_count = 0;
+        for (uint32_t i = 0; i < new_end; ++i) {
+            if (new_alive[i] > 1) throw std::runtime_error("Snapshot bullet has a bad alive flag.");
+            alive_count += new_alive[i];
+        }
+        if (alive_count != new_live) throw std::runtime_error("Snapshot bullet count does not match its alive flags.");
+        if (new_free_list.size() != new_end - new_live) throw std::runtime_error("Snapshot bullet free list does not match its dead slots.");
+        std::vector< uint8_t > listed(new_end, 0);
+        for (uint32_t i : new_free_list) {
+            if (i >= new_end || new_alive[i] || listed[i]) throw std::runtime_error("Snapshot bullet free list names a bad slot.");
+            listed[i] = 1;
+        }
+    }
+    if (new_trail_bullet != BulletPool::Invalid && (new_trail_bullet >= new_end || !new_alive[new_trail_bullet])) {
+        throw std::runtime_error("Snapshot trail follows a bullet that is not in flight.");
+    }
+    
+    std::vector< Building > new_buildings;
+    uint32_t new_grow_epoch = 0;
+    float new_ai_offset = 0.0f;
+    uint8_t new_spawn_waiting = 0;
+    r.array(&new_buildings);
+    r.value(&new_grow_epoch);
+    r.value(&new_ai_offset);
+    r.value(&new_spawn_waiting);
+    if (new_buildings.size() > size_t(max_buildings)) throw std::runtime_error("Snapshot has more buildings than this sim allows.");
+    for (Building const &b : new_buildings) {
+        if (b.spawn_epoch > new_grow_epoch) throw std::runtime_error("Snapshot building was built after the current growth tick.");
+    }
+    size_t heights_array = 0;
+    if (r.locate< uint16_t >(&heights_array, skyline.columns) != skyline.columns) {
+        throw std::runtime_error("Snapshot skyline has a different number of columns.");
+    }
+    
+    double new_time = 0.0;
+    TimerWheel new_timers;
+    r.value(&new_time);
+    r.value(&new_timers.now);
+    for (auto &level : new_timers.slots) {
+        for (auto &slot : level) {
+            r.array(&slot);
+            new_timers.pending += uint32_t(slot.size());
+        }
+    }
+    r.array(&new_timers.overflow);
+    new_timers.pending += uint32_t(new_timers.overflow.size());
+    new_timers.for_each([&](TimerWheel::Timer const &t){
+        //(schedule() never leaves a deadline at or before 'now', and no event here carries data)
+        if (t.event > ReloadBullet || t.data != 0 || t.deadline <= new_timers.now) {
+            throw std::runtime_error("Snapshot has a malformed timer.");
+        }
+    });
+    //slots are restored verbatim (to keep same-tick firing order), so each timer must be in the slot its deadline maps to:
+    if (!new_timers.placed_correctly()) throw std::runtime_error("Snapshot has a timer outside the wheel slot for its deadline.");
+    CounterRNG new_rng;
+    r.value(&new_rng.seed);
+    r.value(&new_rng.counter);
+    
+    uint32_t trail_size = 0;
+    r.value(&trail_size);
+    if (trail_size > TrailRing::Capacity) throw std::runtime_error("Snapshot trail is longer than the trail buffer.");
+    TrailRing new_trail;
+    for (uint32_t i = 0; i < trail_size; ++i) {
+        TrailRing::Point t;
+        r.value(&t);
+        new_trail.push(t.position, t.time);
+    }
+    
+    if (r.at != blob.size()) throw std::runtime_error("Snapshot has trailing data.");
+    
+    //----- commit -----
+    cloud = new_cloud;
+    bullet = new_bullet;
+    trail_bullet = new_trail_bullet;
+    bullet_loaded = new_bullet_loaded;
+    bullet_fired = new_bullet_fired;
+    score = new_score;
+    
+    float *const bullet_fields[7] = { bullets.x.data(), bullets.y.data(), bullets.px.data(), bullets.py.data(), bullets.vx.data(), bullets.vy.data(), bullets.age.data() };
+    for (uint32_t a = 0; a < 7; ++a) {
+        std::memcpy(bullet_fields[a], blob.data() + bullet_arrays[a], new_end * sizeof(float));
+    }
+    std::memcpy(bullets.alive.data(), new_alive, new_end);
+    //slots past 'end' must be dead so batch kernels and draw skip them:
+    if (bullets.end > new_end) std::fill(bullets.alive.begin() + new_end, bullets.alive.begin() + bullets.end, uint8_t(0));
+    bullets.live = new_live;
+    bullets.end = new_end;
+    bullets.free_list.assign(new_free_list.begin(), new_free_list.end());
+    
+    buildings = std::move(new_buildings);
+    grow_epoch = new_grow_epoch;
+    ai_offset = new_ai_offset;
+    spawn_waiting = new_spawn_waiting;
+    std::memcpy(skyline.heights.data(), blob.data() + heights_array, skyline.columns * sizeof(uint16_t));
+    skyline.standing = uint32_t(std::count_if(skyline.heights.begin(), skyline.heights.end(), [](uint16_t h){ return h != 0; }));
+    
+    city_version += 1; //not saved: any change tells observers the city was replaced
+    buildings_grid.clear();
+    for (uint32_t i = 0; i < buildings.size(); ++i) {
+        glm::vec2 lo, hi;
+        building_footprint(buildings[i], &lo, &hi);
+        buildings_grid.insert(i, lo, hi);
+    }
+    
+    time = new_time;
+    timers = std::move(new_timers);
+    rng = new_rng;
+    bullet_trail = new_trail;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+//Game state and simulation for Raging Zeus, with no dependency on SDL or OpenGL.
+// ZeusMode owns one of these and feeds it input; headless.cpp drives one without a window.
+
+#include "BulletPool.hpp"
+#include "UniformGrid.hpp"
+#include "Skyline.hpp"
+#include "CounterRNG.hpp"
+#include "TimerWheel.hpp"
+#include "TrailRing.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+struct ZeusSim {
+    //stress mode: a city thousands of columns wide, stored as a skyline height field, under constant fire
+    //seed: every random choice comes from this instance's own generator, so equal seeds and inputs give equal games
+    explicit ZeusSim(bool stress = false, uint64_t seed = 0);
+    
+    //advance the simulation by 'elapsed' seconds:
+    void update(float elapsed);
+    
+    //player input:
+    void move_cloud(float x);   //x in court coordinates; clamped on the next update
+    void fire();                //fire the loaded bullet on the next update (if cool down allows)
+    
+    //complete simulation state as a flat, versioned binary blob (native byte order, no pointers):
+    // load() throws std::runtime_error if the blob is malformed, from another version,
+    // or from a sim constructed with a different 'stress' setting; the sim is left unchanged when it throws.
+    static constexpr uint32_t snapshot_version = 2;
+    void save(std::vector< uint8_t > *blob) const;
+    void load(std::vector< uint8_t > const &blob);
+    
+    //----- game state -----
+    const bool stress;
+    static constexpr uint32_t stress_columns = 16384;           //number of skyline columns in stress mode
+    static constexpr uint32_t stress_spawn_batch = 256;         //lots built per spawn in stress mode
+    static constexpr uint32_t stress_fire_batch = 512;          //bullets fired per update in stress mode
+    std::vector< float > stress_fire_random;                    //scratch: random positions/velocities for a fire batch
+    
+    glm::vec2 scene_radius = glm::vec2(7.0f, 5.0f);             //size of the scene
+    glm::vec2 cloud_radius = glm::vec2(1.0f, 0.2f);             //size of Zeus' cloud
+    glm::vec2 bullet_radius = glm::vec2(0.2f, 0.2f);            //size of bullet
+    
+    glm::vec2 cloud = glm::vec2(0.0f, scene_radius.y - 1.0f);   //position of cloud, center of rectangle
+    
+    static constexpr uint32_t max_bullets = 1 << 17;            //capacity of the bullet pool
+    BulletPool bullets = BulletPool(max_bullets);               //bullets in flight (x,y,vx,vy,age)
+    glm::vec2 bullet = glm::vec2(0.0f, cloud.y);                //position of the loaded bullet, waiting on the cloud
+    uint32_t trail_bullet = BulletPool::Invalid;                //most recently fired bullet, followed by the trail
+    glm::vec2 gravity = glm::vec2(0.0f, -9.8f);                  //gravitational acceleration
+    float bullet_cd = 0.5f;                                     //bullet cool down between shots
+    bool bullet_loaded = true;                                  //a bullet is ready on the cloud (reloaded by timer)
+    bool bullet_fired = false;                                  //fire requested, consumed by update
+    std::vector< uint32_t > bullets_landed;                     //scratch: bullets that hit the floor this update
+    
+    uint32_t score = 0;
+    
+    //buildings are stored by when they were built, and their size is computed on demand:
+    struct Building {
+        float x;                    //center x
+        uint32_t spawn_epoch;       //grow_epoch when the building was placed
+    };
+    std::vector< Building > buildings;
+    static constexpr float buildings_width = 1.0f;          //fixed width of each building (static: scene_radius, declared above, is sized from it)
+    const int max_buildings = 7;                            //max number of buildings
+    float grow_rate = 0.1f;                                 //building growing rate
+    float spawn_cd_min = 0.5f;                          //new building min spawn cool down
+    float spawn_cd_max = 2.0f;                          //new building max spawn cool down
+    float grow_cd = 1.0f;                               //building growing cool down
+    uint32_t grow_epoch = 0;                            //number of growth ticks so far; every standing building grows on each one
+    float buildings_floor() const { return -scene_radius.y + 0.1f; }
+    
+    //a building starts grow_rate tall (radius) and gains grow_rate on every growth tick, keeping its bottom on the floor:
+    glm::vec2 building_radius(Building const &b) const {
+        return glm::vec2(buildings_width, grow_rate * float(1 + grow_epoch - b.spawn_epoch));
+    }
+    glm::vec2 building_center(Building const &b) const {
+        return glm::vec2(b.x, buildings_floor() + building_radius(b).y);
+    }
+    //box a building is registered under in the grid: its full column, so growth never needs a grid update:
+    void building_footprint(Building const &b, glm::vec2 *lo, glm::vec2 *hi) const {
+        *lo = glm::vec2(b.x - buildings_width, buildings_floor());
+        *hi = glm::vec2(b.x + buildings_width, scene_radius.y);
+    }
+    
+    //stress mode replaces buildings with a height field of buildings_width-radius columns:
+    // (floor and quantum match a building's bottom and per-grow height change)
+    Skyline skyline = Skyline(-scene_radius.x, scene_radius.x, 2.0f * buildings_width, -scene_radius.y + 0.1f, 2.0f * grow_rate);
+    
+    //broadphase over the scene, buildings are registered by index:
+    // (stress mode has no buildings, so its grid is a single cell rather than thousands of empty ones)
+    UniformGrid buildings_grid = stress ? UniformGrid(glm::vec2(0.0f), glm::vec2(0.0f), 2.0f * buildings_width)
+                                        : UniformGrid(-scene_radius, scene_radius, 2.0f * buildings_width);
+    std::vector< uint32_t > building_candidates;        //scratch: grid query results
+    static constexpr uint32_t max_hits_per_step = 4;    //buildings one bullet can hit in a single update
+    std::vector< uint32_t > buildings_destroyed;        //scratch: buildings hit this update
+    
+    uint32_t city_version = 0;                          //changes whenever buildings or skyline do (lets drawing cache the city)
+    
+    float ai_offset = 0.0f;
+    bool spawn_waiting = false;                         //spawn timer fired while the city was full
+    
+    //----- timed events -----
+    double time = 0.0;                                  //seconds simulated so far
+    static constexpr float timer_rate = 1000.0f;        //timer ticks per second
+    enum TimerEvent : uint32_t {
+        SpawnBuildings,     //place building(s), then reschedule
+        GrowBuildings,      //advance grow_epoch, then reschedule
+        ReloadBullet,       //bullet cool down is over
+    };
+    TimerWheel timers;
+    //timer tick 'seconds' from now:
+    uint64_t timer_ticks(float seconds) const;
+    void on_timer(TimerWheel::Timer const &timer);
+    
+    CounterRNG rng;                                     //per-instance random numbers (spawn timing/offset, bounce jitter, stress fire)
+    
+    //----- pretty gradient trails -----
+    float trail_length = 0.2f;              //original: 1.3f, make shorter
+    TrailRing bullet_trail;                 //timestamped positions (age is time - point.time), oldest first
+};
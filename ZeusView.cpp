@@ -0,0 +1,51 @@
+#include "ZeusView.hpp"
+
+#include <algorithm>
+
+ZeusView::ZeusView(glm::vec2 const &scene_radius, float aspect) {
+    //compute area that should be visible:
+    scene_min = glm::vec2(
+        -scene_radius.x - 2.0f * wall_radius - padding,
+        -scene_radius.y - 2.0f * wall_radius - padding
+    );
+    scene_max = glm::vec2(
+        scene_radius.x + 2.0f * wall_radius + padding,
+        scene_radius.y + 2.0f * wall_radius + 3.0f * score_radius + padding
+    );
+
+    //we'll scale the x coordinate by 1.0 / aspect to make sure things stay square.
+
+    //compute scale factor for court given that...
+    float scale = std::min(
+        (2.0f * aspect) / (scene_max.x - scene_min.x), //... x must fit in [-aspect,aspect] ...
+        (2.0f) / (scene_max.y - scene_min.y) //... y must fit in [-1,1].
+    );
+
+    glm::vec2 center = 0.5f * (scene_max + scene_min);
+
+    //build matrix that scales and translates appropriately:
+    court_to_clip = glm::mat4(
+        glm::vec4(scale / aspect, 0.0f, 0.0f, 0.0f),
+        glm::vec4(0.0f, scale, 0.0f, 0.0f),
+        glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+        glm::vec4(-center.x * (scale / aspect), -center.y * scale, 0.0f, 1.0f)
+    );
+    //NOTE: glm matrices are specified in *Column-Major* order,
+    // so each line above is specifying a *column* of the matrix(!)
+
+    //also build the matrix that takes clip coordinates to court coordinates (used for mouse handling):
+    clip_to_court = glm::mat3x2(
+        glm::vec2(aspect / scale, 0.0f),
+        glm::vec2(0.0f, 1.0f / scale),
+        glm::vec2(center.x, center.y)
+    );
+}
+
+glm::vec2 ZeusView::window_to_court(glm::ivec2 const &pixel, glm::uvec2 const &window_size) const {
+    //convert mouse from window pixels (top-left origin, +y is down) to clip space ([-1,1]x[-1,1], +y is up):
+    glm::vec2 clip = glm::vec2(
+        (pixel.x + 0.5f) / window_size.x * 2.0f - 1.0f,
+        (pixel.y + 0.5f) / window_size.y *-2.0f + 1.0f
+    );
+    return clip_to_court * glm::vec3(clip, 1.0f);
+}
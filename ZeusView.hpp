@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+//Placement of the court in the window:
+// shared by ZeusMode (drawing, mouse handling) and by input replay,
+// so it depends on neither SDL nor OpenGL.
+struct ZeusView {
+    //scene_radius is ZeusSim::scene_radius; aspect is width / height of the output:
+    ZeusView(glm::vec2 const &scene_radius, float aspect);
+    
+    //sizes of the decorations around the court (court units):
+    static constexpr float wall_radius = 0.05f;
+    static constexpr float padding = 0.14f; //padding between outside of walls and edge of window
+    static constexpr float score_radius = 0.1f;
+    
+    //matrix that maps court coordinates to clip coordinates (for OBJECT_TO_CLIP):
+    glm::mat4 court_to_clip;
+    //...and its inverse, from clip coordinates to court coordinates:
+    glm::mat3x2 clip_to_court;
+    
+    //visible court area:
+    glm::vec2 scene_min, scene_max;
+    
+    //window pixel (top-left origin, +y is down) to court coordinates:
+    glm::vec2 window_to_court(glm::ivec2 const &pixel, glm::uvec2 const &window_size) const;
+};
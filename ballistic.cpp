@@ -0,0 +1,80 @@
+#include "ballistic.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+//roots of 0.5*a*t*t + v*t + c in (0,t_max], appended to 'out' (returns count):
+static uint32_t roots_in_step(float a, float v, float c, float t_max, float *out) {
+	uint32_t count = 0;
+	auto keep = [&](float t) {
+		if (t > 0.0f && t <= t_max) out[count++] = t;
+	};
+	if (std::abs(a) < 1e-8f) {
+		if (v != 0.0f) keep(-c / v);
+		return count;
+	}
+	float A = 0.5f * a;
+	float disc = v * v - 4.0f * A * c;
+	if (disc < 0.0f) return count;
+	float s = std::sqrt(disc);
+	//numerically stable form of the quadratic formula:
+	float q = -0.5f * (v + (v < 0.0f ? -s : s));
+	if (q != 0.0f) {
+		keep(q / A);
+		keep(c / q);
+	} else {
+		keep(0.0f);
+	}
+	return count;
+}
+
+void ballistic_bounds(glm::vec2 const &p0, glm::vec2 const &v, glm::vec2 const &a, float t_max, glm::vec2 *lo, glm::vec2 *hi) {
+	assert(lo && hi);
+	glm::vec2 p1 = ballistic_position(p0, v, a, t_max);
+	*lo = glm::min(p0, p1);
+	*hi = glm::max(p0, p1);
+	for (int k = 0; k < 2; ++k) {
+		if (a[k] == 0.0f) continue;
+		float t = -v[k] / a[k]; //where velocity along k is zero
+		if (t > 0.0f && t < t_max) {
+			float apex = p0[k] + v[k] * t + 0.5f * a[k] * t * t;
+			(*lo)[k] = std::min((*lo)[k], apex);
+			(*hi)[k] = std::max((*hi)[k], apex);
+		}
+	}
+}
+
+bool ballistic_toi(glm::vec2 const &p0, glm::vec2 const &v, glm::vec2 const &a, float t_max,
+	glm::vec2 const &lo, glm::vec2 const &hi, float *toi, int *axis) {
+	assert(toi && axis);
+
+	if (p0.x >= lo.x && p0.x <= hi.x && p0.y >= lo.y && p0.y <= hi.y) {
+		*toi = 0.0f;
+		*axis = -1;
+		return true;
+	}
+
+	//the path can only enter the box by crossing a face, so the earliest
+	// face crossing that lands within the other axis' extent is the entry:
+	const float eps = 1e-5f;
+	bool found = false;
+	for (int k = 0; k < 2; ++k) {
+		int o = 1 - k;
+		float faces[2] = { lo[k], hi[k] };
+		for (float face : faces) {
+			float ts[2];
+			uint32_t n = roots_in_step(a[k], v[k], p0[k] - face, t_max, ts);
+			for (uint32_t i = 0; i < n; ++i) {
+				float t = ts[i];
+				if (found && t >= *toi) continue;
+				float other = p0[o] + v[o] * t + 0.5f * a[o] * t * t;
+				if (other < lo[o] - eps || other > hi[o] + eps) continue;
+				*toi = t;
+				*axis = k;
+				found = true;
+			}
+		}
+	}
+	return found;
+}
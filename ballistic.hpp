@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+//Helpers for points moving under constant acceleration:
+//  p(t) = p0 + v*t + 0.5*a*t*t
+
+inline glm::vec2 ballistic_position(glm::vec2 const &p0, glm::vec2 const &v, glm::vec2 const &a, float t) {
+	return p0 + v * t + 0.5f * a * t * t;
+}
+
+//bounding box of the path over t in [0,t_max] (includes the apex if it falls inside the interval):
+void ballistic_bounds(glm::vec2 const &p0, glm::vec2 const &v, glm::vec2 const &a, float t_max, glm::vec2 *lo, glm::vec2 *hi);
+
+//earliest time in [0,t_max] at which the path enters the box [lo,hi]:
+// returns false if it never does. On success, *axis is the axis whose face was
+// crossed (0 == x, 1 == y), or -1 if p0 is already inside the box (*toi == 0).
+// To sweep a box instead of a point, grow [lo,hi] by the moving box's radius.
+bool ballistic_toi(glm::vec2 const &p0, glm::vec2 const &v, glm::vec2 const &a, float t_max,
+	glm::vec2 const &lo, glm::vec2 const &hi, float *toi, int *axis);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <cstdint>
+
+//Count GL calls where they are made, for the "GL calls" stat:
+// wrap each call in the counted paths as GL_COUNTED(glDrawArrays(...)); the wrapped
+// expression keeps its value. The count only grows; readers take differences.
+// (GL calls are only made from the main thread, so this is a plain counter.)
+inline uint64_t &gl_call_count() {
+	static uint64_t count = 0;
+	return count;
+}
+#define GL_COUNTED( CALL ) (gl_call_count() += 1, CALL)
@@ -0,0 +1,247 @@
+//Runs the Raging Zeus simulation with no window or OpenGL context.
+// Useful for CPU-only benchmarking, soak testing, and batch simulation.
+// Input comes from a scripted player or from a log recorded by the game (--record),
+// and is applied through the same ZeusControls the game uses.
+
+#include "ZeusSim.hpp"
+#include "ZeusControls.hpp"
+#include "InputLog.hpp"
+#include "Profiler.hpp"
+#include "Stats.hpp"
+#include "parse_arg.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+//scripted player: sweeps the mouse back and forth across a 640x480 window, clicking regularly:
+struct Script {
+	float tick = 1.0f / 60.0f;
+	uint64_t ticks = 0;
+	uint32_t fire_every = 1;
+
+	uint64_t t = 0; //next tick to script
+	std::vector< InputEvent > queue; //events for the current tick
+	size_t queued = 0; //events from 'queue' already returned
+
+	bool next(InputEvent *evt) {
+		if (queued == queue.size()) {
+			if (t == ticks) return false;
+			queue.clear();
+			queued = 0;
+			InputEvent e;
+			e.time = uint32_t(t * tick * 1000.0f);
+			if (t == 0) {
+				e.type = InputEvent::Resize;
+				e.value = glm::ivec2(640, 480);
+				queue.emplace_back(e);
+			}
+			float phase = float(t) * tick * 0.5f;
+			e.type = InputEvent::MouseMotion;
+			e.value = glm::ivec2(int32_t((0.5f + 0.5f * std::sin(phase)) * 639.0f), 240);
+			queue.emplace_back(e);
+			if (t % fire_every == 0) {
+				e.type = InputEvent::MouseUp;
+				queue.emplace_back(e);
+			}
+			e = InputEvent();
+			e.type = InputEvent::Update;
+			e.elapsed = tick;
+			queue.emplace_back(e);
+			t += 1;
+		}
+		*evt = queue[queued++];
+		return true;
+	}
+};
+
+int main(int argc, char **argv) {
+	//------------  command line ------------
+
+	bool stress = false; //same meaning as the game's --stress
+	uint64_t seed = 0; //random seed for the simulation
+	float tick_rate = 60.0f; //simulation ticks per second
+	uint64_t ticks = 60 * 60; //number of ticks to run (default: one simulated minute)
+	uint32_t fire_every = 30; //ticks between scripted shots
+	uint64_t snapshot_at = ~uint64_t(0); //tick at which to check snapshot save/restore (default: never)
+	std::string replay_filename; //if set, play this input log instead of the script
+	std::string record_filename; //if set, log the input that was played
+	std::string timings_filename; //if set, write per-tick update() times here as CSV
+	std::string profile_filename; //if set, write the profiler's zones here as a Chrome trace at exit
+	std::string stats_filename; //if set, periodically write the sim's counters here ('-' for stdout; JSON lines if it ends in .json, else CSV)
+	uint32_t stats_every = 60; //ticks between stats lines
+	for (int argi = 1; argi < argc; ++argi) {
+		std::string arg = argv[argi];
+		uint32_t n = 0; //parsed numeric arguments (see parse_arg.hpp)
+		float hz = 0.0f;
+		if (arg == "--stress") {
+			stress = true;
+		} else if (arg == "--seed" && argi + 1 < argc && parse_arg(argv[argi+1], &seed)) {
+			argi += 1;
+		} else if (arg == "--tick-rate" && argi + 1 < argc && parse_arg(argv[argi+1], &hz) && hz > 0.0f) {
+			tick_rate = hz;
+			argi += 1;
+		} else if (arg == "--ticks" && argi + 1 < argc && parse_arg(argv[argi+1], &ticks)) {
+			argi += 1;
+		} else if (arg == "--fire-every" && argi + 1 < argc && parse_arg(argv[argi+1], &n) && n > 0) {
+			fire_every = n;
+			argi += 1;
+		} else if (arg == "--snapshot-at" && argi + 1 < argc && parse_arg(argv[argi+1], &snapshot_at)) {
+			argi += 1;
+		} else if (arg == "--replay" && argi + 1 < argc) {
+			replay_filename = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--record" && argi + 1 < argc) {
+			record_filename = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--timings" && argi + 1 < argc) {
+			timings_filename = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--profile" && argi + 1 < argc) {
+			profile_filename = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--stats" && argi + 1 < argc) {
+			stats_filename = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--stats-every" && argi + 1 < argc && parse_arg(argv[argi+1], &n) && n > 0) {
+			stats_every = n;
+			argi += 1;
+		} else {
+			std::cerr << "Usage:\n\t" << argv[0] << " [--stress] [--seed <n>] [--tick-rate <hz>] [--ticks <n>] [--fire-every <ticks>] [--snapshot-at <tick>]\n"
+			          << "\t\t[--replay <input log>] [--record <input log>] [--timings <csv>] [--profile <trace.json>]\n"
+			          << "\t\t[--stats <file.csv|file.json|->] [--stats-every <ticks>]\n"
+			          << "(--replay takes stress and seed from the log and runs it to the end at full speed)" << std::endl;
+			return 1;
+		}
+	}
+
+	//------------  input ------------
+
+	//input source, restartable so the snapshot check can play the same input again:
+	std::unique_ptr< InputLogReader > log;
+	Script script;
+	auto restart = [&]() {
+		if (!replay_filename.empty()) {
+			log.reset(new InputLogReader(replay_filename));
+			stress = log->stress;
+			seed = log->seed;
+		} else {
+			script = Script();
+			script.tick = 1.0f / tick_rate;
+			script.ticks = ticks;
+			script.fire_every = fire_every;
+		}
+	};
+	auto next = [&](InputEvent *evt) {
+		return log ? log->read(evt) : script.next(evt);
+	};
+	restart();
+
+	std::unique_ptr< InputLogWriter > recording;
+	if (!record_filename.empty()) recording.reset(new InputLogWriter(record_filename, seed, stress));
+
+	std::unique_ptr< std::ofstream > timings;
+	if (!timings_filename.empty()) {
+		timings.reset(new std::ofstream(timings_filename));
+		if (!*timings) {
+			std::cerr << "Failed to open '" << timings_filename << "' for writing." << std::endl;
+			return 1;
+		}
+		*timings << "tick,update_us\n";
+	}
+
+	//each tick is a stats "frame":
+	std::unique_ptr< std::ofstream > stats_file;
+	std::ostream *stats_out = nullptr;
+	bool stats_json = false;
+	if (!stats_filename.empty()) {
+		if (stats_filename == "-") {
+			stats_out = &std::cout;
+		} else {
+			stats_file.reset(new std::ofstream(stats_filename));
+			if (!*stats_file) {
+				std::cerr << "Failed to open '" << stats_filename << "' for writing." << std::endl;
+				return 1;
+			}
+			stats_out = stats_file.get();
+		}
+		stats_json = stats_filename.size() >= 5 && stats_filename.substr(stats_filename.size() - 5) == ".json";
+		if (!stats_json) stats_write_csv_header(*stats_out);
+	}
+
+	//------------  simulation ------------
+
+	ZeusSim sim(stress, seed);
+	ZeusControls controls;
+
+	std::vector< uint8_t > snapshot;
+	ZeusControls snapshot_controls;
+	uint64_t tick_count = 0;
+	double seconds = 0.0; //time spent in update()
+	double simulated = 0.0; //simulated time
+
+	InputEvent evt;
+	while (next(&evt)) {
+		if (recording) recording->write(evt);
+		if (evt.type != InputEvent::Update) {
+			controls.apply(evt, &sim);
+			continue;
+		}
+		if (tick_count == snapshot_at) {
+			sim.save(&snapshot);
+			snapshot_controls = controls;
+		}
+		auto before = std::chrono::high_resolution_clock::now();
+		controls.apply(evt, &sim);
+		auto after = std::chrono::high_resolution_clock::now();
+		double elapsed = std::chrono::duration< double >(after - before).count();
+		if (timings) *timings << tick_count << ',' << elapsed * 1e6 << '\n';
+		seconds += elapsed;
+		simulated += evt.elapsed;
+		tick_count += 1;
+		stats_end_frame();
+		if (stats_out && tick_count % stats_every == 0) {
+			if (stats_json) stats_write_json(*stats_out, tick_count);
+			else stats_write_csv(*stats_out, tick_count);
+		}
+	}
+
+	//------------  report ------------
+
+	std::cout << "Simulated " << tick_count << " ticks (" << simulated << "s) in " << seconds << "s"
+	          << " (" << (tick_count ? seconds / tick_count * 1e6 : 0.0) << "us/tick)." << std::endl;
+	std::cout << "  bullets live: " << sim.bullets.live
+	          << ", buildings standing: " << (stress ? sim.skyline.standing : uint32_t(sim.buildings.size())) << std::endl;
+
+	if (!profile_filename.empty() && !profile_write_chrome_trace(profile_filename)) {
+		std::cerr << "Failed to write profile to '" << profile_filename << "'." << std::endl;
+		return 1;
+	}
+
+	//------------  snapshot check ------------
+
+	if (!snapshot.empty()) {
+		//restore into a fresh sim, play the input from the snapshot tick on, and compare final states:
+		ZeusSim replay(stress, seed);
+		replay.load(snapshot);
+		ZeusControls replay_controls = snapshot_controls;
+		restart();
+		uint64_t t = 0;
+		while (next(&evt)) {
+			if (evt.type == InputEvent::Update) t += 1;
+			if (t > snapshot_at) replay_controls.apply(evt, &replay);
+		}
+		std::vector< uint8_t > expected, actual;
+		sim.save(&expected);
+		replay.save(&actual);
+		std::cout << "  snapshot at tick " << snapshot_at << ": " << snapshot.size() << " bytes, replay "
+		          << (expected == actual ? "matches." : "DIVERGES!") << std::endl;
+		if (expected != actual) return 1;
+	}
+
+	return 0;
+}
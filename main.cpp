@@ -8,7 +8,29 @@
 //GL.hpp will include a non-namespace-polluting set of opengl prototypes:
 #include "GL.hpp"
 
+//for rendering without a visible window:
+#include "OffscreenTarget.hpp"
+
+//for replaying recorded input in offscreen runs:
+#include "InputLog.hpp"
+
+//for the fixed-step simulation loop:
+#include "FixedTimestep.hpp"
+
+//for numeric command-line arguments:
+#include "parse_arg.hpp"
+
+//worker threads for CPU-side drawing work:
+#include "JobSystem.hpp"
+
+//for timing the frame's phases:
+#include "Profiler.hpp"
+
+//per-frame counters (and their periodic output):
+#include "Stats.hpp"
+
 //for screenshots:
+#include "Screenshots.hpp"
 #include "load_save_png.hpp"
 
 //Includes for libSDL:
@@ -16,10 +38,16 @@
 
 //...and for c++ standard library functions:
 #include <chrono>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <memory>
 #include <algorithm>
+#include <string>
+
+static StatCounter update_ms("update ms");
+static StatCounter draw_ms("draw ms");
+static StatCounter frame_ms("frame ms");
 
 int main(int argc, char **argv) {
 #ifdef _WIN32
@@ -27,10 +55,102 @@ int main(int argc, char **argv) {
 	try {
 #endif
 
+	//------------  command line ------------
+
+	bool stress = false; //wide skyline city under constant fire, for load testing
+	uint64_t seed = 0; //random seed for the simulation
+	FixedTimestep timestep; //simulation tick rate and catch-up limit
+	std::string record_filename; //if set, log input here (replay with zeus-headless --replay)
+	bool cpu_rects = false; //expand rectangles into vertices on the CPU instead of drawing them instanced
+	uint32_t workers = JobSystem::default_workers(); //threads helping the main thread build draw data (0: none)
+	std::string profile_filename = "profile.json"; //where F8 writes the profiler's Chrome trace
+	bool profile_at_exit = false; //also write it when the game exits (set by --profile)
+	std::string stats_filename; //if set, periodically write the stats here ('-' for stdout; JSON lines if it ends in .json, else CSV)
+	uint32_t stats_every = 60; //frames between stats lines
+	bool offscreen = false; //draw into an OffscreenTarget on a hidden window instead of a visible one (set by --offscreen)
+	uint64_t offscreen_frames = 0; //frames to draw offscreen (0: until the replayed log ends)
+	glm::uvec2 offscreen_size = glm::uvec2(640, 480);
+	std::string replay_filename; //if set (offscreen only), play this input log instead of live input
+	std::string capture_filename; //if set (offscreen only), save the last frame drawn here as a PNG
+	for (int argi = 1; argi < argc; ++argi) {
+		std::string arg = argv[argi];
+		uint32_t n = 0, m = 0; //parsed numeric arguments (see parse_arg.hpp)
+		float hz = 0.0f;
+		if (arg == "--stress") {
+			stress = true;
+		} else if (arg == "--seed" && argi + 1 < argc && parse_arg(argv[argi+1], &seed)) {
+			argi += 1;
+		} else if (arg == "--tick-rate" && argi + 1 < argc && parse_arg(argv[argi+1], &hz) && hz > 0.0f) {
+			timestep.tick = 1.0f / hz;
+			argi += 1;
+		} else if (arg == "--max-steps" && argi + 1 < argc && parse_arg(argv[argi+1], &n) && n > 0) {
+			timestep.max_steps = n;
+			argi += 1;
+		} else if (arg == "--record" && argi + 1 < argc) {
+			record_filename = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--cpu-rects") {
+			cpu_rects = true;
+		} else if (arg == "--workers" && argi + 1 < argc && parse_arg(argv[argi+1], &workers)) {
+			argi += 1;
+		} else if (arg == "--profile" && argi + 1 < argc) {
+			profile_filename = argv[argi+1];
+			profile_at_exit = true;
+			argi += 1;
+		} else if (arg == "--stats" && argi + 1 < argc) {
+			stats_filename = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--stats-every" && argi + 1 < argc && parse_arg(argv[argi+1], &n) && n > 0) {
+			stats_every = n;
+			argi += 1;
+		} else if (arg == "--offscreen" && argi + 1 < argc && parse_arg(argv[argi+1], &offscreen_frames)) {
+			offscreen = true;
+			argi += 1;
+		} else if (arg == "--size" && argi + 2 < argc && parse_arg(argv[argi+1], &n) && n > 0 && parse_arg(argv[argi+2], &m) && m > 0) {
+			offscreen_size = glm::uvec2(n, m);
+			argi += 2;
+		} else if (arg == "--replay" && argi + 1 < argc) {
+			replay_filename = argv[argi+1];
+			argi += 1;
+		} else if (arg == "--capture" && argi + 1 < argc) {
+			capture_filename = argv[argi+1];
+			argi += 1;
+		} else {
+			std::cerr << "Usage:\n\t" << argv[0] << " [--stress] [--seed <n>] [--tick-rate <hz>] [--max-steps <n>] [--record <input log>] [--cpu-rects] [--workers <n>] [--profile <trace.json>]\n"
+			          << "\t\t[--stats <file.csv|file.json|->] [--stats-every <frames>]\n"
+			          << "\t\t[--offscreen <frames> [--size <w> <h>] [--replay <input log>] [--capture <png>]]\n"
+			          << "(--offscreen draws one tick per frame, as fast as possible, into a framebuffer object on a hidden window;\n"
+			          << " it uses SDL's 'offscreen' video driver unless SDL_VIDEODRIVER says otherwise)" << std::endl;
+			return 1;
+		}
+	}
+	if (!offscreen && !(replay_filename.empty() && capture_filename.empty())) {
+		std::cerr << "--replay and --capture need --offscreen." << std::endl;
+		return 1;
+	}
+	if (offscreen && offscreen_frames == 0 && replay_filename.empty()) {
+		std::cerr << "--offscreen 0 (run to the end of the log) needs --replay." << std::endl;
+		return 1;
+	}
+
+	//replayed input decides the sim's stress and seed:
+	std::unique_ptr< InputLogReader > replay;
+	if (!replay_filename.empty()) {
+		replay.reset(new InputLogReader(replay_filename));
+		stress = replay->stress;
+		seed = replay->seed;
+	}
+
 	//------------  initialization ------------
 
+	//Offscreen runs default to SDL's "offscreen" video driver (EGL pbuffers; works on Mesa llvmpipe with no display or GPU):
+	if (offscreen) SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+
 	//Initialize SDL library:
-	SDL_Init(SDL_INIT_VIDEO);
+	if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+		std::cerr << "Error initializing SDL: " << SDL_GetError() << std::endl;
+		return 1;
+	}
 
 	//Ask for an OpenGL context version 3.3, core profile, enable debug:
 	SDL_GL_ResetAttributes();
@@ -46,11 +166,12 @@ int main(int argc, char **argv) {
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
 
-	//create window:
+	//create window (offscreen runs only need it for the GL context, and draw to an OffscreenTarget):
 	SDL_Window *window = SDL_CreateWindow(
 		"gp21 pong", //TODO: remember to set a title for your game!
 		SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
 		640, 480, //TODO: modify window size if you'd like
+		offscreen ? (SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN) :
 		SDL_WINDOW_OPENGL
 		| SDL_WINDOW_RESIZABLE //uncomment to allow resizing
 		| SDL_WINDOW_ALLOW_HIGHDPI //uncomment for full resolution on high-DPI screens
@@ -76,8 +197,10 @@ int main(int argc, char **argv) {
 	//On windows, load OpenGL entrypoints: (does nothing on other platforms)
 	init_GL();
 
-	//Set VSYNC + Late Swap (prevents crazy FPS):
-	if (SDL_GL_SetSwapInterval(-1) != 0) {
+	//Set VSYNC + Late Swap (prevents crazy FPS -- except offscreen, where crazy FPS is the point):
+	if (offscreen) {
+		SDL_GL_SetSwapInterval(0);
+	} else if (SDL_GL_SetSwapInterval(-1) != 0) {
 		std::cerr << "NOTE: couldn't set vsync + late swap tearing (" << SDL_GetError() << ")." << std::endl;
 		if (SDL_GL_SetSwapInterval(1) != 0) {
 			std::cerr << "NOTE: couldn't set vsync (" << SDL_GetError() << ")." << std::endl;
@@ -89,7 +212,17 @@ int main(int argc, char **argv) {
 
 	//------------ create game mode + make current --------------
 	//Mode::set_current(std::make_shared< PongMode >());          // TODO: change this to my own game mode
-    Mode::set_current(std::make_shared< ZeusMode >());
+	JobSystem jobs(workers);
+	std::shared_ptr< ZeusMode > zeus = std::make_shared< ZeusMode >(stress, seed, record_filename);
+	zeus->renderer.instanced = !cpu_rects;
+	zeus->renderer.jobs = &jobs;
+	Mode::set_current(zeus);
+
+	std::unique_ptr< OffscreenTarget > offscreen_target;
+	if (offscreen) offscreen_target.reset(new OffscreenTarget(offscreen_size));
+
+	//PRINTSCREEN captures (read back and saved without stalling the frame loop):
+	std::unique_ptr< Screenshots > screenshots(new Screenshots);
         
 	//------------ main loop ------------
 
@@ -99,6 +232,11 @@ int main(int argc, char **argv) {
 	glm::uvec2 drawable_size; //size of drawable (physical pixels)
 	//On non-highDPI displays, window_size will always equal drawable_size.
 	auto on_resize = [&](){
+		if (offscreen_target) {
+			//(the target's viewport is set when it is bound)
+			window_size = drawable_size = offscreen_target->size;
+			return;
+		}
 		int w,h;
 		SDL_GetWindowSize(window, &w, &h);
 		window_size = glm::uvec2(w, h);
@@ -108,12 +246,41 @@ int main(int argc, char **argv) {
 	};
 	on_resize();
 
+	//write the profiler's zones (the most recent ProfileRingSize per thread, so the last several hundred frames or more):
+	auto write_profile = [&](){
+		std::cout << "Writing profile to '" << profile_filename << "'." << std::endl;
+		if (!profile_write_chrome_trace(profile_filename)) {
+			std::cerr << "Failed to write profile to '" << profile_filename << "'." << std::endl;
+		}
+	};
+
+	//periodic stats output:
+	std::unique_ptr< std::ofstream > stats_file;
+	std::ostream *stats_out = nullptr;
+	bool stats_json = false;
+	if (!stats_filename.empty()) {
+		if (stats_filename == "-") {
+			stats_out = &std::cout;
+		} else {
+			stats_file.reset(new std::ofstream(stats_filename));
+			if (!*stats_file) throw std::runtime_error("Failed to open '" + stats_filename + "' for writing stats.");
+			stats_out = stats_file.get();
+		}
+		stats_json = stats_filename.size() >= 5 && stats_filename.substr(stats_filename.size() - 5) == ".json";
+		if (!stats_json) stats_write_csv_header(*stats_out);
+	}
+	uint64_t frame = 0;
+	auto start_time = std::chrono::high_resolution_clock::now();
+
 	//This will loop until the current mode is set to null:
 	while (Mode::current) {
+		PROFILE_ZONE("frame");
+		auto frame_start = std::chrono::high_resolution_clock::now();
 		//every pass through the game loop creates one frame of output
 		//  by performing three steps:
 
 		{ //(1) process any events that are pending
+			PROFILE_ZONE("events");
 			static SDL_Event evt;
 			while (SDL_PollEvent(&evt) == 1) {
 				//handle resizing:
@@ -128,49 +295,99 @@ int main(int argc, char **argv) {
 					break;
 				} else if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_PRINTSCREEN) {
 					// --- screenshot key ---
-					std::string filename = "screenshot.png";
-					std::cout << "Saving screenshot to '" << filename << "'." << std::endl;
-					glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-					glReadBuffer(GL_FRONT);
-					int w,h;
-					SDL_GL_GetDrawableSize(window, &w, &h);
-					std::vector< glm::u8vec4 > data(w*h);
-					glReadPixels(0,0,w,h, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
-					for (auto &px : data) {
-						px.a = 0xff;
-					}
-					save_png(filename, glm::uvec2(w,h), data.data(), LowerLeftOrigin);
+					//(captures the next frame drawn)
+					screenshots->request("screenshot.png");
+				} else if (evt.type == SDL_KEYDOWN && evt.key.repeat == 0 && evt.key.keysym.sym == SDLK_F8) {
+					// --- profile key ---
+					write_profile();
 				}
 			}
 			if (!Mode::current) break;
 		}
 
-		{ //(2) call the current mode's "update" function to deal with elapsed time:
+		{ //(2) call the current mode's "update" function once per fixed tick of elapsed time:
+			PROFILE_ZONE("update");
 			auto current_time = std::chrono::high_resolution_clock::now();
 			static auto previous_time = current_time;
 			float elapsed = std::chrono::duration< float >(current_time - previous_time).count();
 			previous_time = current_time;
 
 			//if frames are taking a very long time to process,
-			//lag to avoid spiral of death:
-			elapsed = std::min(0.1f, elapsed);
-
-			Mode::current->update(elapsed);         // game update here
+			//timestep.max_steps limits catch-up to avoid spiral of death:
+			//offscreen runs don't follow the clock: each frame is exactly one tick, so output is reproducible:
+			uint32_t steps = offscreen ? 1 : timestep.advance(elapsed);
+			for (uint32_t step = 0; step < steps && Mode::current; ++step) {
+				if (replay) {
+					//apply logged input up to and including the next tick:
+					InputEvent input;
+					bool more;
+					while ((more = replay->read(&input)) && input.type != InputEvent::Update) {
+						zeus->apply(input);
+					}
+					if (more) zeus->apply(input);
+					else Mode::set_current(nullptr);
+				} else {
+					Mode::current->update(timestep.tick);         // game update here
+				}
+			}
+			update_ms += std::chrono::duration< double, std::milli >(std::chrono::high_resolution_clock::now() - current_time).count();
 			if (!Mode::current) break;
 		}
 
 		{ //(3) call the current mode's "draw" function to produce output:
-		
-			Mode::current->draw(drawable_size);
+			PROFILE_ZONE("draw");
+			auto before = std::chrono::high_resolution_clock::now();
+			if (offscreen_target) offscreen_target->bind();
+			Mode::current->draw(drawable_size, offscreen ? 1.0f : timestep.alpha());
+			draw_ms += std::chrono::duration< double, std::milli >(std::chrono::high_resolution_clock::now() - before).count();
+		}
+
+		{ //start any requested screenshot of the frame just drawn, and move earlier ones along:
+			PROFILE_ZONE("screenshots");
+			if (offscreen_target) screenshots->capture(offscreen_target->framebuffer, GL_COLOR_ATTACHMENT0, offscreen_target->size);
+			else screenshots->capture(0, GL_BACK, drawable_size);
+			screenshots->poll();
+		}
+
+		{ //Wait until the recently-drawn frame is shown before doing it all again:
+			PROFILE_ZONE("swap");
+			if (!offscreen) SDL_GL_SwapWindow(window);
 		}
 
-		//Wait until the recently-drawn frame is shown before doing it all again:
-		SDL_GL_SwapWindow(window);
+		//close the frame's counters:
+		frame_ms += std::chrono::duration< double, std::milli >(std::chrono::high_resolution_clock::now() - frame_start).count();
+		stats_end_frame();
+		frame += 1;
+		if (stats_out && frame % stats_every == 0) {
+			if (stats_json) stats_write_json(*stats_out, frame);
+			else stats_write_csv(*stats_out, frame);
+			stats_out->flush();
+		}
+		if (offscreen && frame == offscreen_frames) Mode::set_current(nullptr);
 	}
 
+	if (offscreen) {
+		double seconds = std::chrono::duration< double >(std::chrono::high_resolution_clock::now() - start_time).count();
+		std::cout << "Drew " << frame << " frames offscreen (" << offscreen_size.x << "x" << offscreen_size.y << ") in " << seconds << "s"
+		          << " (" << (seconds > 0.0 ? frame / seconds : 0.0) << " frames/s)." << std::endl;
+		if (!capture_filename.empty()) {
+			std::cout << "Saving last frame to '" << capture_filename << "'." << std::endl;
+			std::vector< glm::u8vec4 > data;
+			offscreen_target->read(&data);
+			save_png(capture_filename, offscreen_target->size, data.data(), LowerLeftOrigin);
+		}
+	}
+	//(GL objects go while the context still exists)
+	screenshots->finish();
+	screenshots.reset();
+	offscreen_target.reset();
+	zeus.reset(); //(Mode::current is already null, so this is the last reference)
+
 
 	//------------  teardown ------------
 
+	if (profile_at_exit) write_profile();
+
 	SDL_GL_DeleteContext(context);
 	context = 0;
 
@@ -0,0 +1,42 @@
+#pragma once
+
+//Numeric command-line arguments:
+// each returns false (instead of throwing, like std::stoi and friends) unless the
+// whole string is a number that fits, so callers can fall through to their usage text.
+
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+inline bool parse_arg(std::string const &str, uint64_t *out) {
+	if (str.empty() || !std::isdigit(static_cast< unsigned char >(str[0]))) return false; //(stoull would accept "-1" and leading spaces)
+	try {
+		size_t used = 0;
+		uint64_t value = std::stoull(str, &used);
+		if (used != str.size()) return false;
+		*out = value;
+		return true;
+	} catch (std::logic_error const &) { //std::invalid_argument or std::out_of_range
+		return false;
+	}
+}
+
+inline bool parse_arg(std::string const &str, uint32_t *out) {
+	uint64_t value = 0;
+	if (!parse_arg(str, &value) || value > UINT32_MAX) return false;
+	*out = uint32_t(value);
+	return true;
+}
+
+inline bool parse_arg(std::string const &str, float *out) {
+	try {
+		size_t used = 0;
+		float value = std::stof(str, &used);
+		if (used != str.size()) return false;
+		*out = value;
+		return true;
+	} catch (std::logic_error const &) {
+		return false;
+	}
+}
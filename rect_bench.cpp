@@ -0,0 +1,75 @@
+//Microbenchmark for rectangle-to-vertex expansion (see RectExpand.hpp):
+// times expand_rects against expand_rects_scalar and checks they agree.
+
+#include "RectExpand.hpp"
+#include "CounterRNG.hpp"
+#include "parse_arg.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv) {
+	//------------  command line ------------
+
+	uint32_t count = 200000; //rectangles per batch
+	uint32_t repeats = 100; //batches timed
+	for (int argi = 1; argi < argc; ++argi) {
+		std::string arg = argv[argi];
+		uint32_t n = 0; //(see parse_arg.hpp)
+		if (arg == "--rects" && argi + 1 < argc && parse_arg(argv[argi+1], &n) && n > 0) {
+			count = n;
+			argi += 1;
+		} else if (arg == "--repeats" && argi + 1 < argc && parse_arg(argv[argi+1], &n) && n > 0) {
+			repeats = n;
+			argi += 1;
+		} else {
+			std::cerr << "Usage:\n\t" << argv[0] << " [--rects <n>] [--repeats <n>]" << std::endl;
+			return 1;
+		}
+	}
+
+	//------------  data ------------
+
+	//rectangles scattered over (and a little past) a 16x12 area, like a stress-mode frame:
+	CounterRNG rng(1);
+	std::vector< RectInstance > rects;
+	rects.reserve(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		glm::vec2 center = glm::vec2(rng.next_float(-9.0f, 9.0f), rng.next_float(-7.0f, 7.0f));
+		glm::vec2 radius = glm::vec2(rng.next_float(0.01f, 1.0f), rng.next_float(0.01f, 1.0f));
+		glm::u8vec4 color = glm::u8vec4(uint8_t(rng.next_u32(256)), uint8_t(rng.next_u32(256)), uint8_t(rng.next_u32(256)), 0xff);
+		rects.emplace_back(center, radius, color);
+	}
+	glm::vec2 center = glm::vec2(0.0f, 0.5f);
+	glm::vec2 to_normalized = glm::vec2(32767.0f / 8.0f, 32767.0f / 6.0f);
+
+	std::vector< RectVertex > simd_out(6 * size_t(count), RectVertex(glm::i16vec2(0), glm::u8vec4(0)));
+	std::vector< RectVertex > scalar_out = simd_out;
+
+	//------------  timing ------------
+
+	auto time = [&](void (*expand)(RectInstance const *, size_t, glm::vec2 const &, glm::vec2 const &, RectVertex *), std::vector< RectVertex > &out) {
+		expand(rects.data(), rects.size(), center, to_normalized, out.data()); //warm up
+		auto before = std::chrono::high_resolution_clock::now();
+		for (uint32_t r = 0; r < repeats; ++r) {
+			expand(rects.data(), rects.size(), center, to_normalized, out.data());
+		}
+		auto after = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration< double >(after - before).count() / (double(repeats) * count) * 1e9;
+	};
+
+	double scalar_ns = time(expand_rects_scalar, scalar_out);
+	double simd_ns = time(expand_rects, simd_out);
+
+	bool match = std::memcmp(simd_out.data(), scalar_out.data(), simd_out.size() * sizeof(RectVertex)) == 0;
+
+	std::cout << count << " rects x " << repeats << " repeats:\n"
+	          << "  scalar: " << scalar_ns << " ns/rect\n"
+	          << "  expand_rects: " << simd_ns << " ns/rect (" << (simd_ns > 0.0 ? scalar_ns / simd_ns : 0.0) << "x)\n"
+	          << "  outputs " << (match ? "match." : "DIFFER!") << std::endl;
+
+	return match ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+//Compile-time SIMD feature detection shared by the vectorized kernels.
+// ZEUS_SSE2 is set whenever SSE2 intrinsics are usable (always true on x86-64);
+// kernels must keep a scalar fallback for everything else.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ZEUS_SSE2 1
+#include <emmintrin.h>
+#else
+#define ZEUS_SSE2 0
+#endif
+
+//number of floats processed per SIMD batch (arrays are padded to a multiple of this):
+#define ZEUS_SIMD_WIDTH 4